@@ -0,0 +1,97 @@
+#include "adc.h"
+
+Adc::Adc()
+  : nchan( 0 )
+  , fast(  NONE )
+  , cur(   0 )
+  , slot(  0 )
+  , slow(  0 )
+{
+}
+
+byte Adc::add( byte pin, byte mode )
+{
+  if (nchan >= MAX_CHANNELS)
+    return NONE;
+
+  channel & c = chan[nchan];
+  c.pin   = pin;
+  c.mode  = mode;
+  c.count = 0;
+  c.sum   = 0;
+  c.last  = analogRead( pin );  // valid value before start()
+  c.filt  = c.last << 4;
+
+  DIDR0 |= (1 << pin);  // no digital input buffer: less noise
+  if ((mode == FAST) && (fast == NONE))
+    fast = nchan;
+  else
+    c.mode = FILTERED;
+  return nchan++;
+}
+
+void Adc::start(void)
+{
+  if (! nchan)
+    return;
+
+  cur = next();
+  ADMUX  = (1 << REFS0) | chan[cur].pin;  // AVcc reference
+  ADCSRB = 0;
+  ADCSRA = (1 << ADEN) | (1 << ADSC) | (1 << ADIE)
+         | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);  // clk/128: 125 kHz, 9.6k conversions per sec
+}
+
+byte Adc::next(void)
+{
+  if (++slot >= FAST_EVERY)
+    slot = 0;
+  if (! slot && (fast != NONE))
+    return fast;
+
+  for (byte i = 0; i < nchan; ++i) {
+    if (++slow >= nchan)
+      slow = 0;
+    if (slow != fast)
+      return slow;
+  }
+  return fast;  // FAST channel only
+}
+
+void Adc::sample(void)
+{
+  channel & c = chan[cur];
+  c.last = ADC;
+
+  cur = next();  // start next conversion first: constant sample rate
+  ADMUX   = (1 << REFS0) | chan[cur].pin;
+  ADCSRA |= (1 << ADSC);
+
+  if (c.mode != FILTERED)
+    return;
+
+  c.sum += c.last;
+  if (++c.count & (DECIMATE - 1))
+    return;
+
+  // every DECIMATE samples (about 30 msec per FILTERED channel):
+  int16_t const diff = (word) (c.sum >> 4) - c.filt;
+  c.filt += diff >> FILTER;
+  c.sum   = 0;
+}
+
+word Adc::value( byte ch )
+{
+  noInterrupts();
+  word const v = chan[ch].filt;
+  interrupts();
+  return v;
+}
+
+word Adc::raw( byte ch )
+{
+  noInterrupts();
+  word const v = chan[ch].last;
+  interrupts();
+  return v;
+}
@@ -0,0 +1,51 @@
+#ifndef Adc_h
+#define Adc_h
+
+#include <Arduino.h>
+
+class Adc  // ADC channels converted in background: ADC_vect stores result and starts next conversion
+{
+  public:
+    enum MODE {
+      FAST = 0   // every FAST_EVERY conversions (about 1 kHz) - one channel only
+     ,FILTERED   // oversampled and low pass filtered - sharing the other conversions
+    };
+
+  private:
+    enum {
+      MAX_CHANNELS = 4
+     ,FAST_EVERY   = 10   // 9.6k conversions per sec at clk/128
+     ,DECIMATE     = 256  // samples summed per value: 256x (16^2) oversampling -> 4 bits more
+     ,FILTER       = 3    // low pass of values: filt += (value - filt) >> FILTER
+     ,NONE         = 0xff
+    };
+
+    struct channel {
+      byte          pin;    // analog pin
+      byte          mode;   // MODE
+      byte          count;  // samples in sum (wraps at DECIMATE)
+      word          last;   // last sample
+      word          filt;   // filtered value (1/16 LSB)
+      uint32_t      sum;    // sum of samples of current decimation cycle
+    };
+
+    channel   chan[MAX_CHANNELS];
+    byte      nchan;  // channels added
+    byte      fast;   // FAST channel (NONE: none)
+    byte      cur;    // channel being converted
+    byte      slot;   // conversion counter 0..FAST_EVERY-1
+    byte      slow;   // last FILTERED channel converted
+
+    byte      next(void);  // channel of next conversion
+
+  public:
+    Adc();
+    byte    add( byte pin, byte mode );  // before start(): first sample by analogRead() (blocking) / return: channel
+    void    start(void);                 // start background conversions
+    void    sample(void);                // ADC_vect: store result and start next conversion
+
+    word    value( byte ch );  // FILTERED: filtered value in 1/16 LSB (0..16368)
+    word    raw( byte ch );    // last sample (no waiting)
+};
+
+#endif
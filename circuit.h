@@ -0,0 +1,152 @@
+#ifndef Circuit_h
+#define Circuit_h
+
+#include <Arduino.h>
+#include "ctrl.h"
+#include "display.h"
+#include "journal.h"
+#include "switch.h"
+#include "relay.h"
+
+// circuits: a manual switch and a relay each, described by circuitTable at compile time
+//
+// the table is never indexed at run time: Circuits<> unrolls every loop over the
+// circuits, so the values of the table are constants in code (no RAM, no flash table)
+// and a circuit costs its Switch and Relay only
+//
+// to add a circuit (CIRCUITS in ctrl.h):
+//   - pins in ctrl.h
+//   - a Display::NUM behind NUM_LUM, its place in the info matrix and a menu category (display.cpp)
+//   - Journal events for switching and switch mode (journal.h)
+//   - 64 bytes EEPROM for the ring of days below 0x240 (e.g. 0x200, 0x1c0: backup records grow, too)
+// up to 4 circuits: the power fail record grows by 8 bytes per circuit (see ctrl.h)
+
+class Circuit
+{
+  public:
+    enum ID {       // index in circuitTable, Ctrl::switches and Ctrl::relays
+      PUMP = 0      // fixed: serial protocols and backup record types
+     ,LAMP
+    };
+    enum SOURCE {   // what switches the relay in automatic mode
+      SRC_NONE = 0  // nothing: automatic mode is off
+     ,SRC_TEMP      // Temp: solar heating (all follow the running times of the first one)
+     ,SRC_LUMI      // Lumi: dusk until secOff
+    };
+    enum REF {      // start of day: Relay::today() and ring of days
+      REF_DAWN = 0
+     ,REF_DUSK
+    };
+
+    struct def {
+      byte      pinSwitch;
+      byte      pinRelay;
+      byte      num;       // Display::NUM (info and menu)
+      byte      source;    // SOURCE
+      byte      ref;       // REF
+      byte      key;       // Display::KEY in menu mode
+      boolean   restart;   // pressed in info mode: restart display timeout
+      byte      evSwitch;  // Journal::EV of relay switched on/off
+      byte      evMode;    // Journal::EV of switch mode changed
+      byte      chord;     // circuit of other switch: both pressed enter/exit the menu
+      int       eeDays;    // EEPROM address of ring of days
+      short     keymin;    // KEYPAD: resistor range of key
+      short     keymax;
+    };
+};
+
+static constexpr Circuit::def circuitTable[] =
+{
+    // pinSwitch      pinRelay       num                source              ref
+    //   key                restart  evSwitch          evMode                  chord          eeDays  keymin keymax
+     { PIN_PumpSwitch, PIN_PumpRelay, Display::NUM_PUMP, Circuit::SRC_TEMP, Circuit::REF_DAWN
+      ,Display::KEY_ITEM, false,   Journal::EV_PUMP, Journal::EV_PUMP_MODE, Circuit::LAMP, 0x240,     0,   66 }
+    ,{ PIN_LampSwitch, PIN_LampRelay, Display::NUM_LAMP, Circuit::SRC_LUMI, Circuit::REF_DUSK
+      ,Display::KEY_CAT,  true,    Journal::EV_LAMP, Journal::EV_LAMP_MODE, Circuit::PUMP, 0x280,   389,  596 }
+};
+
+static_assert( NELEMENTS(circuitTable) == CIRCUITS, "CIRCUITS (ctrl.h) does not match circuitTable" );
+
+template <byte C = 0, boolean END = (C >= CIRCUITS)>
+class Circuits  // loops over all circuits (unrolled at compile time)
+{
+    static_assert( (circuitTable[C].chord < CIRCUITS) && (circuitTable[C].chord != C), "chord: other circuit" );
+
+  public:
+    static void init( Ctrl * ctrl )  // pin modes (relays off)
+    {
+      ctrl->relays[C].init(   circuitTable[C].pinRelay );
+      ctrl->switches[C].init( circuitTable[C].pinSwitch );
+      Circuits<C + 1>::init( ctrl );
+    }
+
+    static void setup( Ctrl * ctrl )
+    {
+      ctrl->relays[C].setup( ctrl, circuitTable[C].num, circuitTable[C].evSwitch, circuitTable[C].evMode,
+                                   circuitTable[C].eeDays );
+      ctrl->switches[C].setup( ctrl, & ctrl->switches[circuitTable[C].chord],
+                                     circuitTable[C].keymin, circuitTable[C].keymax );
+      Circuits<C + 1>::setup( ctrl );
+    }
+
+    static void secLoop( Ctrl * ctrl )  // relays may fall back from "temporary on"
+    {
+      ctrl->relays[C].secLoop();
+      Circuits<C + 1>::secLoop( ctrl );
+    }
+
+    static void loop( Ctrl * ctrl )  // switches: pass notes to display and relay
+    {
+      Switch & sw = ctrl->switches[C];
+      switch (sw.loop()) {
+        case Switch::NOTE_MENU:    ctrl->display->toggleMode();                 break;
+        case Switch::NOTE_KEY:     ctrl->display->key( circuitTable[C].key );   break;
+        case Switch::NOTE_SWMODE:  ctrl->relays[C].swMode( sw.mode() );         break;
+        case Switch::NOTE_TIMEOUT: if (circuitTable[C].restart)  // others may be pressed somewhere else
+                                     ctrl->display->restart();
+                                   break;
+      }
+      Circuits<C + 1>::loop( ctrl );
+    }
+
+    template <byte REF>
+    static void newDay( Ctrl * ctrl )  // relays, whose day starts at REF
+    {
+      if (circuitTable[C].ref == REF)
+        ctrl->relays[C].newDay();
+      Circuits<C + 1>::template newDay<REF>( ctrl );
+    }
+
+    template <byte SRC>
+    static void autoOn( Ctrl * ctrl, byte on )  // relays switched by SRC
+    {
+      if (circuitTable[C].source == SRC)
+        ctrl->relays[C].autoOn( on );
+      Circuits<C + 1>::template autoOn<SRC>( ctrl, on );
+    }
+
+    static constexpr byte first( byte src )  // first circuit switched by src (CIRCUITS: none)
+    {
+      return (circuitTable[C].source == src) ? C : Circuits<C + 1>::first( src );
+    }
+};
+
+template <byte C>
+class Circuits<C, true>  // behind last circuit
+{
+  public:
+    static void init(    Ctrl * ) {}
+    static void setup(   Ctrl * ) {}
+    static void secLoop( Ctrl * ) {}
+    static void loop(    Ctrl * ) {}
+
+    template <byte REF>
+    static void newDay( Ctrl * ) {}
+
+    template <byte SRC>
+    static void autoOn( Ctrl *, byte ) {}
+
+    static constexpr byte first( byte ) { return CIRCUITS; }
+};
+
+#endif
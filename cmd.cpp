@@ -0,0 +1,344 @@
+#include "cmd.h"
+#include "relay.h"
+#include "lumi.h"
+#include "temp.h"
+#include "journal.h"
+#include "circuit.h"  // Circuit::PUMP, Circuit::LAMP
+
+Cmd::param const Cmd::params[] PROGMEM =
+                 { { "pausing",     Ctrl::SUB_TEMP, Temp::PAR_PAUSING   }
+                  ,{ "b4start",     Ctrl::SUB_TEMP, Temp::PAR_B4START   }
+                  ,{ "running",     Ctrl::SUB_TEMP, Temp::PAR_RUNNING   }
+                  ,{ "b4stop",      Ctrl::SUB_TEMP, Temp::PAR_B4STOP    }
+                  ,{ "lumswitch",   Ctrl::SUB_LUMI, Lumi::PAR_LUMSWITCH }
+                  ,{ "lumdawn",     Ctrl::SUB_LUMI, Lumi::PAR_LUMDAWN   }
+                  ,{ "timeoff",     Ctrl::SUB_LUMI, Lumi::PAR_TIMEOFF   }
+                  ,{ "seccorr",     Ctrl::SUB_LUMI, Lumi::PAR_SECCORR   }
+                  ,{ "day",         Ctrl::SUB_LUMI, Lumi::PAR_DAY       }
+                  ,{ "pumptimeout", Ctrl::SUB_RELAY + Circuit::PUMP, Relay::PAR_TIMEOUT }
+                  ,{ "lamptimeout", Ctrl::SUB_RELAY + Circuit::LAMP, Relay::PAR_TIMEOUT } };
+
+char const Cmd::dumpNames[][10] PROGMEM =
+                 { "sec"                                        //  0
+                  ,"sol", "pool", "ins", "air", "box"           //  1..5: Temp::SENSOR + 1
+                  ,"devok", "result"                            //  6, 7
+                  ,"pump", "pumptoday", "pumptotal"             //  8..10
+                  ,"lamp", "lamptoday", "lamptotal"             // 11..13
+                  ,"lum", "lumi" };                             // 14, 15
+
+Cmd::Cmd()
+  : llen(    0 )
+  , pos(     0 )
+  , listing( LIST_NONE )
+  , next(    0 )
+{
+  out[0] = 0;
+}
+
+void Cmd::setup( Ctrl * ctrlArg )
+{
+  ctrl = ctrlArg;
+}
+
+void Cmd::loop(void)
+{
+  if (out[pos]) {  // reply pending
+    byte n = Serial.availableForWrite();  // bytes we can write without blocking
+    while (n-- && out[pos])
+      Serial.write( out[pos++] );
+    return;
+  }
+
+  switch (listing) {
+    case LIST_PARAMS:
+      if (next < NELEMENTS(params))
+        show( next++ );
+      else
+        listing = LIST_NONE;
+      return;
+
+    case LIST_DUMP:
+      if (! dump( next++ ))
+        listing = LIST_NONE;
+      return;
+
+    case LIST_HIST:
+      if (! hist( next++ ))
+        listing = LIST_NONE;
+      return;
+
+    case LIST_JOURNAL:
+      if (! journal( next++ ))
+        listing = LIST_NONE;
+      return;
+
+    case LIST_HOURS:
+      if (! hours( next++ ))
+        listing = LIST_NONE;
+      return;
+
+    case LIST_DAYS:
+      if (! days( next++ ))
+        listing = LIST_NONE;
+      return;
+  }
+
+  for (byte n = RX_PER_LOOP; n && Serial.available(); --n) {
+    char const c = Serial.read();
+    if ((c == '\r') || (c == '\n')) {
+      if (llen)
+        exec();
+      llen = 0;
+      return;  // one command per loop
+    }
+    if (llen < (LINE_LEN - 1))
+      line[llen++] = c;
+    else
+      llen = LINE_LEN;  // too long: rejected at end of line
+  }
+}
+
+static char * temperature( char * cp, Temperature t )  // "-12.3" / "-" when invalid
+{
+  if (! t.valid()) {
+    *cp++ = '-';
+    return cp;
+  }
+  long val = ((long) t.raw() * 10 + 8) >> 4;  // 0.1 K
+  if (val < 0) {
+    *cp++ = '-';
+    val = -val;
+  }
+  ltoa( val / 10, cp, 10 );
+  cp += strlen( cp );
+  *cp++ = '.';
+  *cp++ = '0' + (val % 10);
+  return cp;
+}
+
+static char * token( char * cp )  // terminate word / return: start of next word
+{
+  while (*cp && (*cp != ' '))
+    ++cp;
+  while (*cp == ' ')
+    *cp++ = 0;
+  return cp;
+}
+
+void Cmd::exec(void)
+{
+  if (llen >= LINE_LEN) {
+    reply( PSTR( "?" ) );
+    return;
+  }
+  line[llen] = 0;
+
+  char * const name = token( line );
+  char * const val  = token( name );
+
+  if (! strcmp_P( line, PSTR( "list" ) )) {
+    listing = LIST_PARAMS;
+    next = 0;
+    return;
+  }
+  if (! strcmp_P( line, PSTR( "dump" ) )) {
+    listing = LIST_DUMP;
+    next = 0;
+    return;
+  }
+  if (! strcmp_P( line, PSTR( "hist" ) )) {
+    listing = LIST_HIST;
+    next = 0;
+    return;
+  }
+  if (! strcmp_P( line, PSTR( "journal" ) )) {
+    listing = LIST_JOURNAL;
+    next = 0;
+    return;
+  }
+  if (! strcmp_P( line, PSTR( "hours" ) )) {
+    listing = LIST_HOURS;
+    next = 0;
+    return;
+  }
+  if (! strcmp_P( line, PSTR( "days" ) )) {
+    listing = LIST_DAYS;
+    next = 0;
+    return;
+  }
+  if (! strcmp_P( line, PSTR( "backup" ) )) {
+    ctrl->backup( Lumi::MANUAL );
+    reply( PSTR( "ok" ) );
+    return;
+  }
+
+  byte const idx = find( name );
+  if (idx < NELEMENTS(params)) {
+    if (! strcmp_P( line, PSTR( "get" ) ) && ! *val) {
+      show( idx );
+      return;
+    }
+    if (! strcmp_P( line, PSTR( "set" ) ) && *val) {
+      char * end;
+      long const v = strtol( val, & end, 10 );
+      if (! *end && set( idx, v )) {
+        show( idx );
+        return;
+      }
+    }
+  }
+  reply( PSTR( "?" ) );
+}
+
+byte Cmd::find( char const * name )
+{
+  byte idx;
+  for (idx = 0; idx < NELEMENTS(params); ++idx)
+    if (! strcmp_P( name, params[idx].name ))
+      break;
+  return idx;
+}
+
+long Cmd::get( byte idx )
+{
+  return ctrl->get( pgm_read_byte( & params[idx].sub ), pgm_read_byte( & params[idx].par ) );
+}
+
+boolean Cmd::set( byte idx, long val )
+{
+  return ctrl->set( pgm_read_byte( & params[idx].sub ), pgm_read_byte( & params[idx].par ), val );
+}
+
+void Cmd::show( byte idx )
+{
+  strcpy_P( out, params[idx].name );
+  char * cp = out + strlen( out );
+  *cp++ = '=';
+  ltoa( get( idx ), cp, 10 );
+  send( cp + strlen( cp ) );
+}
+
+boolean Cmd::dump( byte idx )
+{
+  if (idx >= NELEMENTS(dumpNames))
+    return false;
+
+  strcpy_P( out, dumpNames[idx] );
+  char * cp = out + strlen( out );
+  *cp++ = '=';
+
+  long val;
+  switch (idx) {
+    case 0:  val = ctrl->sec;                  break;
+    case 6:  val = ctrl->temp->sensorsOk();    break;
+    case 7:  val = ctrl->temp->result();       break;
+    case 8:  val = ctrl->relays[Circuit::PUMP].isOn();    break;
+    case 9:  val = ctrl->relays[Circuit::PUMP].today();   break;
+    case 10: val = ctrl->relays[Circuit::PUMP].total();   break;
+    case 11: val = ctrl->relays[Circuit::LAMP].isOn();    break;
+    case 12: val = ctrl->relays[Circuit::LAMP].today();   break;
+    case 13: val = ctrl->relays[Circuit::LAMP].total();   break;
+    case 14: val = ctrl->lumi->lum();          break;
+    case 15: val = ctrl->lumi->state();        break;
+
+    default:  // temperature
+      send( temperature( cp, ctrl->temp->raw( idx - 1 ) ) );
+      return true;
+  }
+  ltoa( val, cp, 10 );
+  send( cp + strlen( cp ) );
+  return true;
+}
+
+boolean Cmd::hist( byte idx )
+{
+  Temp::decision d;
+  if (! ctrl->temp->history( idx, d ))
+    return false;
+
+  char * cp = strcpy_P( out, PSTR( "age=" ) ) + 4;
+  ultoa( (word) ((word) (ctrl->sec / 60) - d.min), cp, 10 );
+  cp = strcpy_P( cp + strlen( cp ), PSTR( " result=" ) ) + 8;
+  ltoa( d.cause & ~Temp::DEC_ON, cp, 10 );
+  cp = strcpy_P( cp + strlen( cp ), (d.cause & Temp::DEC_ON) ? PSTR( " on=1 diff=" ) : PSTR( " on=0 diff=" ) ) + 11;
+  cp = temperature( cp, Temperature::fromRaw( d.diff * 4 ) );
+  cp = strcpy_P( cp, PSTR( " thres=" ) ) + 7;
+  send( temperature( cp, Temperature::fromRaw( d.thres * 4 ) ) );
+  return true;
+}
+
+boolean Cmd::journal( byte idx )
+{
+  Journal::record r;
+  if (! ctrl->journal->get( idx, r ))
+    return false;
+
+  char * cp = strcpy_P( out, PSTR( "min=" ) ) + 4;
+  ultoa( r.min, cp, 10 );
+  cp = strcpy_P( cp + strlen( cp ), PSTR( " type=" ) ) + 6;
+  ultoa( r.type, cp, 10 );
+  cp = strcpy_P( cp + strlen( cp ), PSTR( " val=" ) ) + 5;
+  ultoa( r.val, cp, 10 );
+  send( cp + strlen( cp ) );
+  return true;
+}
+
+boolean Cmd::hours( byte idx )
+{
+  if (idx >= 24)
+    return false;
+
+  char * cp = strcpy_P( out, PSTR( "hour=" ) ) + 5;
+  ultoa( idx, cp, 10 );
+  cp = strcpy_P( cp + strlen( cp ), PSTR( " pump=" ) ) + 6;
+  ultoa( ctrl->relays[Circuit::PUMP].hour( idx ), cp, 10 );
+  cp = strcpy_P( cp + strlen( cp ), PSTR( " lamp=" ) ) + 6;
+  ultoa( ctrl->relays[Circuit::LAMP].hour( idx ), cp, 10 );
+  send( cp + strlen( cp ) );
+  return true;
+}
+
+static char * day( char * cp, Relay * relay, byte idx )  // "<min>/<switched on>" or "-"
+{
+  word minutes;
+  byte sw;
+  if (! relay->day( idx, minutes, sw )) {
+    *cp = '-';
+    return cp + 1;
+  }
+  ultoa( minutes, cp, 10 );
+  cp += strlen( cp );
+  *cp++ = '/';
+  ultoa( sw, cp, 10 );
+  return cp + strlen( cp );
+}
+
+boolean Cmd::days( byte idx )
+{
+  word minutes;
+  byte sw;
+  if (! ctrl->relays[Circuit::PUMP].day( idx, minutes, sw ) && ! ctrl->relays[Circuit::LAMP].day( idx, minutes, sw ))
+    return false;
+
+  char * cp = strcpy_P( out, PSTR( "day=" ) ) + 4;
+  ultoa( idx + 1, cp, 10 );
+  cp = strcpy_P( cp + strlen( cp ), PSTR( " pump=" ) ) + 6;
+  cp = day( cp, & ctrl->relays[Circuit::PUMP], idx );
+  cp = strcpy_P( cp, PSTR( " lamp=" ) ) + 6;
+  send( day( cp, & ctrl->relays[Circuit::LAMP], idx ) );
+  return true;
+}
+
+void Cmd::reply( char const * str )
+{
+  strcpy_P( out, str );
+  send( out + strlen( out ) );
+}
+
+void Cmd::send( char * end )
+{
+  *end++ = '\r';
+  *end++ = '\n';
+  *end   = 0;
+  pos = 0;
+}
@@ -0,0 +1,80 @@
+#ifndef Cmd_h
+#define Cmd_h
+
+#include <Arduino.h>
+#include "ctrl.h"
+
+// text commands on serial input (9600 baud), when COMMANDS is defined in ctrl.h
+//
+//   list                 all settings, one "name=value" per line
+//   get <name>           one setting
+//   set <name> <value>   change setting (same limits as in menu) / "?" when out of range
+//   backup               manual backup (as in menu "Systemwerte")
+//   dump                 current values, one "name=value" per line
+//   journal              switching events (newest first): "min=<n> type=<n> val=<n>" (see journal.h)
+//   hist                 last pump decisions (newest first): "age=<min> result=<n> on=<0/1> diff=<K> thres=<K>"
+//   hours                minutes on per hour after midnight (aged 3/4 per day): "hour=<h> pump=<min> lamp=<min>"
+//   days                 last 30 days (newest first): "day=<n> pump=<min>/<switched on> lamp=<min>/<switched on>"
+//
+// settings:
+//   pausing, b4start, running, b4stop   temperature thresholds 0..9 (as in menu)
+//   lumswitch, lumdawn                  luminance 0..1024 (= 0..100%) - kept relative to calibrated threshold
+//   timeoff                             lamp off: secs after astron. midnight (+/- 12h)
+//   seccorr                             midnight correction in secs (+/- 4h)
+//   day                                 day of year of last dawn 1..365 (0: unknown) for the sunrise/sunset model
+//   pumptimeout, lamptimeout            "temporary on" in minutes 1..360
+
+class Cmd
+{
+  private:
+    enum {
+      LINE_LEN    = 24  // incl. terminating 0
+     ,OUT_LEN     = 48  // longest reply line incl. "\r\n" and 0
+     ,RX_PER_LOOP = 8   // max. chars parsed per loop()
+    };
+    enum LIST {
+      LIST_NONE = 0
+     ,LIST_PARAMS
+     ,LIST_DUMP
+     ,LIST_HIST
+     ,LIST_JOURNAL
+     ,LIST_HOURS
+     ,LIST_DAYS
+    };
+
+    struct param {
+      char          name[12];
+      byte          sub;   // Ctrl::SUB
+      byte          par;   // PARAM of sub system
+    };
+    static param const params[];      // in flash
+    static char const  dumpNames[][10]; // in flash
+
+    char      line[LINE_LEN];  // received chars
+    byte      llen;     // length of line (LINE_LEN: too long)
+    char      out[OUT_LEN];    // reply line
+    byte      pos;      // next char of out to pass to UART (out[pos] == 0: idle)
+    byte      listing;  // LIST
+    byte      next;     // next line to list
+    Ctrl    * ctrl;
+
+    void      exec(void);              // execute received line
+    byte      find( char const * name );
+    long      get( byte idx );
+    boolean   set( byte idx, long val );
+    void      show( byte idx );        // reply "name=value" of setting
+    boolean   dump( byte idx );        // reply "name=value" of dump line / false: no more
+    boolean   hist( byte idx );        // reply decision / false: no more
+    boolean   journal( byte idx );     // reply journal record / false: no more
+    boolean   hours( byte idx );       // reply minutes on of hour / false: no more
+    boolean   days( byte idx );        // reply minutes on and switches of day / false: no more
+    void      reply( char const * str );  // reply flash string
+    void      send( char * end );      // terminate reply line and start sending
+
+  public:
+    Cmd();
+    void    setup( Ctrl * ctrl );
+    void    loop(void);  // send reply / list next line / parse at most RX_PER_LOOP chars
+};
+
+#endif
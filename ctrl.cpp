@@ -7,57 +7,95 @@
 #include "relay.h"      // relay control (on/off and duration, "total on since ...")
 #include "lumi.h"       // luminance ctrl (dusk, dawn, backup, restore, ...)
 #include "temp.h"       // temperature ctrl (night, backup, restore, ...)
+#include "log.h"        // debug messages
+#include "journal.h"    // switching events in EEPROM
+#include "events.h"     // posted side effects
+
+volatile byte Ctrl::crumb __attribute__ ((section (".noinit")));
+byte          Ctrl::mcusr __attribute__ ((section (".noinit")));
+
+#ifdef __AVR__  // not in host builds (see tools/host)
+// runs before .data and .bss are initialized:
+// a watchdog reset leaves the watchdog enabled - disable it, before it bites again
+static void readResetCause( void ) __attribute__ ((naked, used, section (".init3")));
+static void readResetCause( void )
+{
+  byte r2;
+  __asm__ __volatile__ ( "mov %0, r2" : "=r" (r2) );  // optiboot passes MCUSR in r2, when it cleared it
+  Ctrl::mcusr = MCUSR ? MCUSR : r2;
+  MCUSR = 0;
+  wdt_disable();
+}
+#endif
+
+extern uint8_t   __data_start;  // start of globals
+extern uint8_t   __heap_start;  // end of globals
+extern char    * __brkval;      // end of heap (0: malloc() not used)
+
+enum { RAM_PAINT = 0xc5 };  // never written pattern
+
+#ifdef __AVR__
+// runs before .data and .bss are initialized (stack not yet used):
+// paint RAM behind the globals - ramFree() counts what is still painted
+static void paintRam( void ) __attribute__ ((naked, used, section (".init3")));
+static void paintRam( void )
+{
+  for (uint8_t * p = & __heap_start; p <= (uint8_t *) RAMEND; ++p)
+    *p = RAM_PAINT;
+}
+#endif
 
 Ctrl::Ctrl( Display * displayArg,
-            Switch  * pumpSwitchArg,
-            Switch  * lampSwitchArg,
-            Relay   * pumpRelayArg,
-            Relay   * lampRelayArg,
+            Switch  * switchesArg,
+            Relay   * relaysArg,
             Lumi    * lumiArg,
-            Temp    * tempArg )
+            Temp    * tempArg,
+            Journal * journalArg,
+            Events  * eventsArg )
         : display(    displayArg )
-        , pumpSwitch( pumpSwitchArg )
-        , lampSwitch( lampSwitchArg )
-        , pumpRelay(  pumpRelayArg )
-        , lampRelay(  lampRelayArg )
+        , switches(   switchesArg )
+        , relays(     relaysArg )
         , lumi(       lumiArg )
         , temp(       tempArg )
+        , journal(    journalArg )
+        , events(     eventsArg )
         , sec(        -1 )  // 0 in 1st loop !
         , totalOn(    0 )
         , todayOn(    0 )
+        , saved(      0 )
 {}
 
 #ifdef DEBUG
 void Ctrl::minLoop()
 {
-  unsigned long m = (sec / 60);
-  unsigned long h = (m / 60);  m %= 60;
-
-  Serial.print( " alive: " );
-  const char * unit = " h:mm";
-  if (h >= 24) {
-    Serial.print( h / 24 );    h %= 24;
-    Serial.print( "," );
-    if (h < 10)
-      Serial.print( "0" );
-    unit = " d,hh:mm";
-  }
-  Serial.print( h );
-  Serial.print( ":" );
-  if (m < 10)
-    Serial.print( "0" );
-  Serial.print( m );
-  Serial.println( unit );
+  Log::put( Log::MSG_ALIVE, & sec, sizeof(sec) );
 }
 #endif
 
+// record of len bytes: type, length, data and padding (1..4 bytes) to 4 byte boundary
+static constexpr int recordLen( int len ) { return (len + 6) & ~3; }
+
 void Ctrl::backup( byte whence )
 {
-  if (whence == Lumi::NOCHANGE)
-    return;
+  static_assert( 16 + recordLen( 8 ) + CIRCUITS * recordLen( Relay::BACKUP_LEN )
+                 + recordLen( Lumi::BACKUP_LEN ) + recordLen( Temp::BACKUP_LEN ) + 1 <= EE_ADDR_DAYS,
+                 "backup records overlap rings of days" );
+
+  crumb = CRUMB_BACKUP;
+  if (whence == Lumi::NOCHANGE) {
+    if ((sec % 3600) || ! sec)
+      return;
+    whence = Lumi::CHECKPOINT;  // hourly: save changed records only
+  }
 
-  if (whence != Lumi::MANUAL)
-    temp->night( whence == Lumi::DUSK );  // explicit autoOn and save min/max
+  if ((whence == Lumi::DUSK) || (whence == Lumi::DAWN)) {
+    events->post( Events::EV_NIGHT, 0, whence == Lumi::DUSK );  // explicit autoOn and save min/max
+    events->flush();  // records below include the new day (relays, temp)
+    journal->put( (whence == Lumi::DUSK) ? Journal::EV_DUSK : Journal::EV_DAWN );
+  } else if (whence == Lumi::MANUAL) {
+    saved = 0;  // rewrite all records
+    journal->put( Journal::EV_BACKUP );
+  }
 
   int addr = 0; // current EEPROM address
   int aLen;     // address, where to store length of sub structure
@@ -76,51 +114,101 @@ void Ctrl::backup( byte whence )
   save( aLen, (uint8_t) (addr - (aLen + 1)) );
   wdt_reset();
 
-  addr = save( addr, (uint8_t) EE_TYPE_PUMP );
-  aLen = addr;
-  addr = pumpRelay->backup( addr + 1 );
-  do addr = save( addr, (uint8_t) 0 ); while (addr & 3);
-  save( aLen, (uint8_t) (addr - (aLen + 1)) );
-  wdt_reset();
+  for (byte c = 0; c < CIRCUITS; ++c)
+    addr = saveRecord( addr, relayType( c ), relays[c].generation() );
+  addr = saveRecord( addr, EE_TYPE_LUMI, lumi->generation() );
+  addr = saveRecord( addr, EE_TYPE_TEMP, temp->generation() );
 
-  addr = save( addr, (uint8_t) EE_TYPE_LAMP );
-  aLen = addr;
-  addr = lampRelay->backup( addr + 1 );
-  do addr = save( addr, (uint8_t) 0 ); while (addr & 3);
-  save( aLen, (uint8_t) (addr - (aLen + 1)) );
-  wdt_reset();
+  save( addr, (uint8_t) EE_TYPE_END );
 
-  addr = save( addr, (uint8_t) EE_TYPE_LUMI );
-  aLen = addr;
-  addr = lumi->backup( addr + 1 );
-  do addr = save( addr, (uint8_t) 0 ); while (addr & 3);
-  save( aLen, (uint8_t) (addr - (aLen + 1)) );
-  wdt_reset();
+  journal->flush();  // at most hourly burst of queued events
+}
 
-  addr = save( addr, (uint8_t) EE_TYPE_TEMP );
-  aLen = addr;
-  addr = temp->backup( addr + 1 );
+int Ctrl::saveRecord( int addr, uint8_t type, byte gen )
+{
+  word const bit = 1 << type;
+  if ((saved & bit) && (recAddr[type] == addr) && (recGen[type] == gen))
+    return addr + 2 + recLen[type];  // unchanged since last save: skip type, len and data
+
+  int const aLen = save( addr, type );
+  switch (type) {
+    case EE_TYPE_LUMI: addr = lumi->backup( aLen + 1 ); break;
+    case EE_TYPE_TEMP: addr = temp->backup( aLen + 1 ); break;
+    default:           addr = relays[relayOf( type )].backup( aLen + 1 ); break;
+  }
   do addr = save( addr, (uint8_t) 0 ); while (addr & 3);
   save( aLen, (uint8_t) (addr - (aLen + 1)) );
   wdt_reset();
 
-  save( addr, (uint8_t) EE_TYPE_END );
+  saved        |= bit;
+  recAddr[type] = aLen - 1;
+  recGen[type]  = gen;
+  recLen[type]  = addr - (aLen + 1);
+  return addr;
+}
+
+byte Ctrl::relayType( byte c )
+{
+  return (c < 2) ? EE_TYPE_RELAY + c : EE_TYPE_RELAY2 + c - 2;
+}
+
+byte Ctrl::relayOf( byte type )
+{
+  if ((type >= EE_TYPE_RELAY) && (type < EE_TYPE_LUMI))
+    return type - EE_TYPE_RELAY;
+  if ((type >= EE_TYPE_RELAY2) && (type < EE_TYPE_COUNT))
+    return type - EE_TYPE_RELAY2 + 2;
+  return CIRCUITS;
 }
 
 void Ctrl::restore( void )
+{
+  countReset();
+  restoreRecords();
+  restorePowerFail();
+}
+
+static void count( int addr )  // increment u16 counter in EEPROM (erased: 0)
+{
+  word n = Ctrl::read2( addr );
+  if (n == 0xffff)
+    n = 1;
+  else if (n < 0xfffe)
+    ++n;
+  Ctrl::save( addr, (uint16_t) n );
+}
+
+void Ctrl::countReset( void )
+{
+  if (mcusr & (1 << PORF))
+    lastReset = RST_POWER;     // crumb and BORF are random
+  else if (mcusr & (1 << WDRF))
+    lastReset = RST_WATCHDOG;
+  else if (mcusr & (1 << BORF))
+    lastReset = RST_BROWNOUT;
+  else
+    lastReset = RST_EXTERN;
+
+  lastCrumb = crumb;
+  count( EE_ADDR_RESET + 2 * lastReset );
+  if ((lastReset == RST_WATCHDOG) && (lastCrumb < CRUMB_COUNT))
+    count( EE_ADDR_RESET + 2 * (RST_COUNT + lastCrumb) );
+}
+
+void Ctrl::restoreRecords( void )
 {
 #if 0
-#define DEBUG(x,y,z)  display->printat( x, y, z );
-#define DBGLN(x,y,z)  display->printat( x, y, z );
+#define EEDEBUG(x,y,z)  display->printat( x, y, z );
+#define EEDBGLN(x,y,z)  display->printat( x, y, z );
 #else
-#define DEBUG(x,y,z)
-#define DBGLN(x,y,z)
+#define EEDEBUG(x,y,z)
+#define EEDBGLN(x,y,z)
 #endif
 
-  DEBUG( 0, 0, "restore from EEPROM content: " )
+  EEDEBUG( 0, 0, "restore from EEPROM content: " )
   if (EEPROM.read( 0 ) != EE_FORMAT) {
-    DEBUG(  0, 1, "unknown format " )
-    DBGLN( 15, 1, (int) EEPROM.read( 0 ) )
+    EEDEBUG(  0, 1, "unknown format " )
+    EEDBGLN( 15, 1, (int) EEPROM.read( 0 ) )
     return;
   }
 
@@ -138,60 +226,112 @@ void Ctrl::restore( void )
           if (len >= 8)
             todayOn = read4( addr + 4 );
         }
-        DEBUG(  0, 0, "addr:           " )
-        DEBUG(  6, 0, (int) addr )
-        DEBUG(  8, 0, "type: " )
-        DEBUG( 14, 0, (int) type )
-        DEBUG(  0, 1, "len:            " )
-        DEBUG(  5, 1, (int) len )
-        DEBUG(  7, 1, "totalOn: " )
-        DEBUG( 10, 1,  totalOn )
-        DEBUG(  7, 1, "todayOn: " )
-        DBGLN( 10, 1,  todayOn )
-        break;
-
-      case EE_TYPE_PUMP:
-        pumpRelay->restore( addr, len );
-        ///DBGLN(  7, 1, "pump relay" )
-        break;
-
-      case EE_TYPE_LAMP:
-        lampRelay->restore( addr, len );
-        ///DBGLN(  7, 1, "lamp relay" )
+        EEDEBUG(  0, 0, "addr:           " )
+        EEDEBUG(  6, 0, (int) addr )
+        EEDEBUG(  8, 0, "type: " )
+        EEDEBUG( 14, 0, (int) type )
+        EEDEBUG(  0, 1, "len:            " )
+        EEDEBUG(  5, 1, (int) len )
+        EEDEBUG(  7, 1, "totalOn: " )
+        EEDEBUG( 10, 1,  totalOn )
+        EEDEBUG(  7, 1, "todayOn: " )
+        EEDBGLN( 10, 1,  todayOn )
         break;
 
       case EE_TYPE_LUMI:
         lumi->restore( addr, len );
-        ///DBGLN(  7, 1, "luminance values" )
+        ///EEDBGLN(  7, 1, "luminance values" )
         break;
 
       case EE_TYPE_TEMP:
         temp->restore( addr, len );
-        ///DBGLN(  7, 1, "temperature values" )
+        ///EEDBGLN(  7, 1, "temperature values" )
         break;
 
       case EE_TYPE_END:
-        ///DBGLN(  7, 1, "end of data" )
+        ///EEDBGLN(  7, 1, "end of data" )
         return;
 
       case EE_TYPE_RSVD:
         break;
 
       default:
-        DEBUG(  0, 0, "addr:           " )
-        DEBUG(  6, 0, (int) addr )
-        DEBUG(  8, 0, "type: " )
-        DEBUG( 14, 0, (int) type )
-        DEBUG(  0, 1, "len:            " )
-        DEBUG(  5, 1, (int) len )
-        DBGLN(  7, 1, "unknown type" )
+        if (relayOf( type ) < CIRCUITS) {
+          relays[relayOf( type )].restore( addr, len );
+          ///EEDBGLN(  7, 1, "relay" )
+          break;
+        }
+        EEDEBUG(  0, 0, "addr:           " )
+        EEDEBUG(  6, 0, (int) addr )
+        EEDEBUG(  8, 0, "type: " )
+        EEDEBUG( 14, 0, (int) type )
+        EEDEBUG(  0, 1, "len:            " )
+        EEDEBUG(  5, 1, (int) len )
+        EEDBGLN(  7, 1, "unknown type" )
         break;
     }
     addr += len;
   }
   while (addr < 1000);
 
-  DBGLN(  7, 1, "address out of space" )
+  EEDBGLN(  7, 1, "address out of space" )
+}
+#undef EEDEBUG
+#undef EEDBGLN
+
+void Ctrl::restorePowerFail( void )
+{
+  uint8_t sum = 0;
+  for (int addr = EE_ADDR_PFAIL; addr < (EE_ADDR_PFAIL + EE_PFAIL_LEN - 1); ++addr)
+    sum += EEPROM.read( addr );
+  if ((uint8_t) ~sum != EEPROM.read( EE_ADDR_PFAIL + EE_PFAIL_LEN - 1 ))
+    return;  // never written or power gone while writing
+
+  unsigned long const stamp = read4( EE_ADDR_PFAIL );
+  if (stamp <= totalOn)
+    return;  // last backup is newer
+
+  totalOn = stamp;
+  todayOn = read4( EE_ADDR_PFAIL + 4 );
+  for (byte c = 0; c < CIRCUITS; ++c)
+    relays[c].restore( EE_ADDR_PFAIL + 8 + 8 * c, 8 );
+}
+
+void Ctrl::pfUpdate( void )
+{
+  uint8_t img[EE_PFAIL_LEN];
+  uint8_t * cp = img;
+
+  cp = put( cp, totalOn + sec );          // as in backup(): stamp to detect newer record
+  cp = put( cp, sec - lumi->dawn() );     // todayOn
+  for (byte c = 0; c < CIRCUITS; ++c)
+    cp = relays[c].counters( cp );
+
+  uint8_t sum = 0;
+  for (uint8_t * sp = img; sp < cp; ++sp)
+    sum += *sp;
+  *cp = ~sum;  // written last: detects record torn by power loss
+
+  noInterrupts();  // powerFail() must not see half of the update
+  memcpy( pfImage, img, EE_PFAIL_LEN );
+  interrupts();
+}
+
+void Ctrl::powerFail( void )
+{
+  // may interrupt an EEPROM access of the main loop between setting the
+  // address/data and the strobe: keep its registers for when it continues
+  uint16_t const eear = EEAR;
+  uint8_t  const eedr = EEDR;
+
+  // just changed bytes are written (about 3.3 msec each),
+  // usually the low bytes of the counters only
+  save( EE_ADDR_PFAIL, pfImage, EE_PFAIL_LEN );
+
+  while (EECR & (1 << EEPE))
+    ;  // EEAR must not change during a write
+  EEAR = eear;
+  EEDR = eedr;
 }
 
 
@@ -252,6 +392,71 @@ long Ctrl::read4( int addr )
 }
 
 
+uint8_t * Ctrl::put( uint8_t * buf, uint32_t val )
+{
+  memcpy( buf, & val, 4 );
+  return buf + 4;
+}
+
+
+word Ctrl::ramFree( void )
+{
+  uint8_t const * p = __brkval ? (uint8_t const *) __brkval : & __heap_start;
+  word n = 0;
+  while ((p <= (uint8_t const *) RAMEND) && (*p++ == RAM_PAINT))
+    ++n;
+  return n;
+}
+
+word Ctrl::ramHeap( void )
+{
+  return __brkval ? (uint8_t const *) __brkval - & __heap_start : 0;
+}
+
+word Ctrl::ramGlobals( void )
+{
+  return & __heap_start - & __data_start;
+}
+
+
+static char const resetNames[] PROGMEM =  // 8 chars per RESET
+  "Ein     Extern  BrownoutWatchdog";
+static char const resetShort[] PROGMEM =  // 4 chars per RESET
+  "Ein Ext.BO  WDT ";
+static char const crumbNames[] PROGMEM =  // 4 chars per CRUMB
+  "loopTempHellEEPRAnz.LCD Ser.";
+
+static void counter( char * buf, char const * name, int addr )  // print name (4 chars in flash) and counter ("nnn")
+{
+  memcpy_P( buf, name, 4 );
+  word n = Ctrl::read2( addr );
+  if (n == 0xffff)
+    n = 0;  // erased
+  else if (n > 999)
+    n = 999;
+  char num[4];
+  char const * cp = Display::itoa( num, sizeof(num), n );
+  memcpy( buf + 7 - (num + 3 - cp), cp, num + 3 - cp );
+}
+
+long Ctrl::get( byte sub, byte par )
+{
+  switch (sub) {
+    case SUB_TEMP: return temp->get( par );
+    case SUB_LUMI: return lumi->get( par );
+    default:       return relays[sub - SUB_RELAY].get( par );
+  }
+}
+
+boolean Ctrl::set( byte sub, byte par, long val )
+{
+  switch (sub) {
+    case SUB_TEMP: return temp->set( par, val );
+    case SUB_LUMI: return lumi->set( par, val );
+    default:       return relays[sub - SUB_RELAY].set( par, val );
+  }
+}
+
 const char * Ctrl::show( char * buf, byte menuitem, byte init )
 {
   memset( buf + 1, ' ', 33 );
@@ -263,20 +468,52 @@ const char * Ctrl::show( char * buf, byte menuitem, byte init )
   switch (menuitem)
   {
     case 1:
-      memcpy( buf +    1, "Betrieb: ", 9 );
+      memcpy_P( buf +    1, PSTR( "Betrieb: " ), 9 );
       Display::dhms( buf +   10, sec );
-      memcpy( buf + 0x12, "gesamt:  ", 9 );
+      memcpy_P( buf + 0x12, PSTR( "gesamt:  " ), 9 );
       Display::dhms( buf + 0x1b, sec + totalOn );
       break;
 
     case 2:
+      memcpy_P( buf +    1, PSTR( "letzter Reset:" ), 14 );
+      memcpy_P( buf + 0x12, resetNames + 8 * lastReset, 8 );
+      if ((lastReset == RST_WATCHDOG) && (lastCrumb < CRUMB_COUNT))
+        memcpy_P( buf + 0x1b, crumbNames + 4 * lastCrumb, 4 );
+      break;
+
+    case 3:  // count of each RESET
+      for (byte i = 0; i < RST_COUNT; ++i)
+        counter( buf + ((i & 2) ? 0x12 : 1) + ((i & 1) ? 8 : 0), resetShort + 4 * i, EE_ADDR_RESET + 2 * i );
+      break;
+
+    case 4:  // watchdog resets per CRUMB
+    case 5:
+      for (byte i = 0; i < 4; ++i) {
+        byte const c = 4 * (menuitem - 4) + i;
+        if (c < CRUMB_COUNT)
+          counter( buf + ((i & 2) ? 0x12 : 1) + ((i & 1) ? 8 : 0), crumbNames + 4 * c, EE_ADDR_RESET + 2 * (RST_COUNT + c) );
+      }
+      break;
+
+    case 6:
+      memcpy_P( buf +    1, PSTR( "Stack frei:" ), 11 );
+      Display::itoa( buf + 13, 5, ramFree() );
+      memcpy_P( buf + 0x12, PSTR( "Glob" ), 4 );
+      Display::itoa( buf + 0x17, 5, ramGlobals() );
+      memcpy_P( buf + 0x1b, PSTR( " Hp" ), 3 );
+      Display::itoa( buf + 0x1e, 5, ramHeap() );
+      buf[0x11] = '|';  // overwritten by itoa()
+      buf[0x22] = '|';
+      break;
+
+    case 7:
       if (! init)
         return 0;
-      memcpy( buf +    1, "backup starten ?", 16 );
-      memcpy( buf + 0x12, "(gelb:nein/b:ja)", 16 );
+      memcpy_P( buf +    1, PSTR( "backup starten ?" ), 16 );
+      memcpy_P( buf + 0x12, PSTR( "(gelb:nein/b:ja)" ), 16 );
       break;
 
-    case 3:
+    case 8:
       if (! init)
         return 0;
 #if 0
@@ -285,8 +522,8 @@ const char * Ctrl::show( char * buf, byte menuitem, byte init )
       display->printat( 0, 1, "        "   " "    "       " );
 #endif
       backup( Lumi::MANUAL );
-      memcpy( buf +    1, "backup", 6 );
-      memcpy( buf + 0x12, "ausgef" STR_UUML "hrt", 10 );
+      memcpy_P( buf +    1, PSTR( "backup" ), 6 );
+      memcpy_P( buf + 0x12, PSTR( "ausgef" STR_UUML "hrt" ), 10 );
       break;
 
     default:
@@ -6,22 +6,39 @@
 
 //define KEYPAD  // enable this switch, when using keypad shield
 #define  NDEBUG  // DEBUG or NDEBUG
+//define TELEMETRY  // binary status records on serial output (see telemetry.h)
+//define COMMANDS   // text commands on serial input (see cmd.h)
+//define MODBUS     // Modbus RTU slave on serial interface (see modbus.h)
 
 #ifdef DEBUG
 #define TEMP_DEBUG  // TEMP_DEBUG or TEMP_NDEBUG: action cause before/time/thres/diff
+#ifndef TELEMETRY
+#define TELEMETRY   // debug messages are sent as telemetry frames (see log.h)
+#endif
 #define DEBUG_EXPR( expr ) expr;
 #else
 #define TEMP_NDEBUG
 #define DEBUG_EXPR( expr )
 #endif
 
+#if defined(COMMANDS) && defined(TELEMETRY)
+#error "COMMANDS and TELEMETRY (or DEBUG) both use the serial output"
+#endif
+#if defined(MODBUS) && (defined(COMMANDS) || defined(TELEMETRY))
+#error "MODBUS needs the serial interface exclusively (no COMMANDS, TELEMETRY or DEBUG)"
+#endif
+
 enum PIN
 {
   // analog pins:
     PIN_Luminance   =  0  // where to read luminance
+#ifdef KEYPAD
+   ,PIN_Keypad      =  0  // resistor ladder of keypad shield
+#endif
 
   // digital pins:
    ,PIN_OneWire     =  2  // OneWire-Bus
+   ,PIN_PowerFail   = 15  // A1 as digital input: supply supervisor (low on power fail)
 
 #ifdef KEYPAD             // using SainSmart LCD Keypad Shield
    ,PIN_PumpSwitch  = 10  // Schalter "Filter-Pumpe"
@@ -57,6 +74,10 @@ enum PIN
 #define TempDevAddrAir   0x28, 0xC5, 0x28, 0xE0, 0x05, 0x00, 0x00, 0xD0
 #define TempDevAddrBox   0x28, 0x9F, 0x31, 0xE0, 0x05, 0x00, 0x00, 0xBE
 
+#define LATITUDE  0  // 1/10 deg north (e.g. 511: 51.1 N) for the sunrise/sunset model (see sun.h) / 0: no model
+
+#define CIRCUITS  2  // switch/relay pairs (see circuitTable in circuit.h)
+
 #define NELEMENTS(i) (sizeof(i)/sizeof(i[0]))
 
 #define CHR_DEGREE   0337
@@ -76,49 +97,108 @@ class Switch;
 class Relay;
 class Lumi;
 class Temp;
+class Journal;
+class Events;
 
 class Ctrl
 {
   public:
     Display     * display;
-    Switch      * pumpSwitch, * lampSwitch;
-    Relay       * pumpRelay,  * lampRelay;
+    Switch      * switches;  // CIRCUITS (Circuit::ID)
+    Relay       * relays;    // CIRCUITS (Circuit::ID)
     Lumi        * lumi;
     Temp        * temp;
+    Journal     * journal;
+    Events      * events;
     unsigned long sec;      // second counter from startup
     unsigned long totalOn;  // about sum of second counter of last runs (incl. todayOn)
     unsigned long todayOn;  // to calculate percentage value of "relais run today"
 #ifdef KEYPAD
     int           keypad;   // analog value of keypad resistor status
 #endif
+
+    enum CRUMB {   // task running: counted per task, when the watchdog bites
+      CRUMB_LOOP = 0  // main loop
+     ,CRUMB_TEMP      // Temp::act(): OneWire bus
+     ,CRUMB_LUMI      // Lumi::secLoop()
+     ,CRUMB_BACKUP    // Ctrl::backup(): EEPROM
+     ,CRUMB_DISPLAY   // Display::refresh()
+     ,CRUMB_LCD       // Lcd::loop()
+     ,CRUMB_SERIAL    // telemetry, commands or Modbus
+
+     ,CRUMB_COUNT
+    };
+    enum RESET {   // reset cause (MCUSR)
+      RST_POWER = 0
+     ,RST_EXTERN      // also: no flag (MCUSR cleared by boot loader)
+     ,RST_BROWNOUT
+     ,RST_WATCHDOG
+
+     ,RST_COUNT
+    };
+    enum SUB {     // sub system of a setting (get/set)
+      SUB_TEMP = 0  // Temp::PARAM
+     ,SUB_LUMI      // Lumi::PARAM
+     ,SUB_RELAY     // + Circuit::ID: Relay::PARAM
+    };
+    static volatile byte crumb;  // CRUMB (.noinit RAM: survives watchdog reset)
+    static byte          mcusr;  // MCUSR at start up (.noinit RAM: read before .bss is cleared)
+
   private:
     enum {
       EE_FORMAT = 1
 
      ,EE_TYPE_RSVD = 0
      ,EE_TYPE_CTRL
-     ,EE_TYPE_PUMP
-     ,EE_TYPE_LAMP
-     ,EE_TYPE_LUMI
+     ,EE_TYPE_RELAY           // circuits 0 and 1 (pump and lamp)
+     ,EE_TYPE_LUMI = EE_TYPE_RELAY + 2
      ,EE_TYPE_TEMP
+     ,EE_TYPE_RELAY2          // circuits 2 and following
 
-     ,EE_TYPE_COUNT
+     ,EE_TYPE_COUNT = EE_TYPE_RELAY2 + CIRCUITS - 2
      ,EE_TYPE_END = 0xff
+
+     ,EE_ADDR_DAYS  = 0x240  // Relay rings of days up to 0x2bf (see circuit.h): end of backup records
+     // 0x2c0..0x3bf: Journal ring (outside of backup records)
+     ,EE_ADDR_RESET = 0x3c0  // reset counters: u16 per RESET, u16 per CRUMB (watchdog resets)
+     ,EE_PFAIL_LEN  = 9 + 8 * CIRCUITS  // 4+4 ctrl, 8 per relay, 1 checksum
+     ,EE_ADDR_PFAIL = (EE_PFAIL_LEN <= 0x20) ? 0x3e0 : 0x400 - EE_PFAIL_LEN  // power fail record (outside of backup records)
     };
+    static_assert( EE_ADDR_PFAIL >= EE_ADDR_RESET + 2 * (RST_COUNT + CRUMB_COUNT), "power fail record overlaps reset counters" );
+
+    uint8_t       pfImage[EE_PFAIL_LEN];  // pre-serialized power fail record
+
+    word          saved;                  // bit mask of record types saved since boot up
+    byte          recGen[EE_TYPE_COUNT];  // generation of sub system, when record saved
+    byte          recLen[EE_TYPE_COUNT];  // length of saved record
+    int           recAddr[EE_TYPE_COUNT]; // address of saved record
+
+    byte          lastReset;  // RESET of this start up
+    byte          lastCrumb;  // crumb at start up (CRUMB, when lastReset is RST_WATCHDOG)
+
+    int          saveRecord( int addr, uint8_t type, byte gen );  // skipped, when unchanged
+    static byte  relayType( byte c );   // EE_TYPE of record of circuit c
+    static byte  relayOf( byte type );  // circuit of record type (CIRCUITS: no relay record)
+
+    void         countReset( void );        // count cause of this start up in EEPROM
+    void         restoreRecords( void );    // restore from last backup
+    void         restorePowerFail( void );  // restore counters from power fail record, when newer
 
   public:
     Ctrl( Display * display
-         ,Switch  * pumpSwitch
-         ,Switch  * lampSwitch
-         ,Relay   * pumpRelay
-         ,Relay   * lampRelay
+         ,Switch  * switches
+         ,Relay   * relays
          ,Lumi    * lumi
          ,Temp    * temp
+         ,Journal * journal
+         ,Events  * events
         );
 
     void         minLoop( void );       // called every full minute
-    void         backup( byte whence ); // called with retval of lumi::secLoop and manual by menu: Ctrl::show()
+    void         backup( byte whence ); // called with retval of lumi::secLoop (hourly checkpoint) and manual by menu: Ctrl::show()
     void         restore( void );  // called once at startup (end of setup())
+    void         pfUpdate( void );  // called every second: pre-serialize power fail record
+    void         powerFail( void ); // called by interrupt on power fail: write power fail record
 
     static int    save( int addr, uint8_t const * data, uint8_t len = 1 );
     static int    save( int addr, uint8_t         val );
@@ -130,6 +210,15 @@ class Ctrl
     static short read2( int addr );
     static long  read4( int addr );
 
+    static uint8_t * put( uint8_t * buf, uint32_t val );  // serialize into RAM buffer
+
+    static word  ramFree( void );     // min. free bytes between heap and stack since boot up
+    static word  ramHeap( void );     // bytes allocated by malloc()
+    static word  ramGlobals( void );  // .data, .bss and .noinit
+
+    long         get( byte sub, byte par );            // setting of sub system (SUB)
+    boolean      set( byte sub, byte par, long val );  // false: out of range
+
     const char * show( char * buf, byte menuitem, byte init );
 };
 
@@ -3,19 +3,32 @@
 #include "ctrl.h"
 #include "switch.h"     // Switch::ON, Switch::OFF, ...
 #include "relay.h"      // Relay::show()
+#include "circuit.h"    // Circuit::LAMP, Circuit::PUMP
 #include "lumi.h"       // Lumi::show()
 #include "temp.h"       // Temp::show()
+#include "journal.h"    // Journal::show()
+#include "sun.h"        // Sun::DAYS
 #include "display.h"
+#include "log.h"        // debug messages
 
 struct infoPos {
   byte         num;     // to once build index[] array
   byte         pos;     // row and col of info
   byte         len;     // total space for that part of info
   char         abbr;    // abbreviation letter
-  char const * name;    // long name
+  char const * name;    // long name (in flash)
 };
 
-static infoPos const infoMatrix[] =
+static char const nameAir[]  PROGMEM = "Luft";
+static char const namePool[] PROGMEM = "Wasser";
+static char const nameSol[]  PROGMEM = "Solar";
+static char const nameIns[]  PROGMEM = "Einstr" STR_OUML "md" STR_UUML "se";
+static char const nameBox[]  PROGMEM = "Controller";
+static char const nameLum[]  PROGMEM = "Helligkeit";
+static char const nameLamp[] PROGMEM = "Beleuchtung";
+static char const namePump[] PROGMEM = "Pumpe";
+
+static infoPos const infoMatrix[] PROGMEM =
 {
       //     col   0123456789abcdef
       // row     +------------------+
@@ -23,42 +36,287 @@ static infoPos const infoMatrix[] =
       // 1       | W:28° E:33° baPA |
       //         +------------------+
 
-       { Display::NUM_AIR,     0, 5, 'L', "Luft"        }
-      ,{ Display::NUM_POOL, 0x10, 5, 'W', "Wasser"      }
-      ,{ Display::NUM_SOL,     6, 5, 'S', "Solar"       }
-      ,{ Display::NUM_INS,  0x16, 5, 'E', "Einstr" STR_OUML "md" STR_UUML "se" }
-      ,{ Display::NUM_BOX,     0, 0, 'C', "Controller"  }
+       { Display::NUM_AIR,     0, 5, 'L', nameAir  }
+      ,{ Display::NUM_POOL, 0x10, 5, 'W', namePool }
+      ,{ Display::NUM_SOL,     6, 5, 'S', nameSol  }
+      ,{ Display::NUM_INS,  0x16, 5, 'E', nameIns  }
+      ,{ Display::NUM_BOX,     0, 0, 'C', nameBox  }
 
-      ,{ Display::NUM_LUM,   0xc, 4, 'H', "Helligkeit"  }
-      ,{ Display::NUM_LAMP, 0x1c, 2, 'B', "Beleuchtung" }
-      ,{ Display::NUM_PUMP, 0x1e, 2, 'P', "Pumpe"       }
+      ,{ Display::NUM_LUM,   0xc, 4, 'H', nameLum  }
+      ,{ Display::NUM_LAMP, 0x1c, 2, 'B', nameLamp }
+      ,{ Display::NUM_PUMP, 0x1e, 2, 'P', namePump }
 };
 
 byte matrixIndex[Display::NUM_COUNT];  // num -> idx
 
+static char const * infoName( byte idx )  // long name (in flash)
+{
+  return (char const *) pgm_read_ptr( & infoMatrix[idx].name );
+}
+
+// menu categories: the item content is built by the show function of the sub system
+// (returning 0, when there is no further item in this category)
+// behind the first info items of show, the adjust items of the category follow (see below)
+
+typedef char const * (* showFn)( Ctrl * ctrl, char * buf, byte menuitem, byte init, byte arg );
+
+struct menuCat {
+  char const * header;  // 1st and 2nd line (in flash) / 0: "Temperatur-Werte" with name of arg
+  showFn       show;    // items / 0: intro (any item jumps to 1st category)
+  byte         arg;     // passed to show
+  byte         info;    // items of show before the adjust items (later ones: show gets item - adjLen)
+  byte         adj;     // 1st adjust item (index of adjTable)
+  byte         adjLen;  // adjust items
+};
+
+static char const * showSys( Ctrl * ctrl, char * buf, byte menuitem, byte init, byte )
+{
+  return ctrl->show( buf, menuitem, init );
+}
+
+static char const * showTime( Ctrl * ctrl, char * buf, byte menuitem, byte, byte )
+{
+  return ctrl->lumi->showTime( buf, menuitem );
+}
+
+static char const * showDown( Ctrl * ctrl, char * buf, byte menuitem, byte, byte )
+{
+  return ctrl->lumi->showDown( buf, menuitem );
+}
+
+static char const * showRelay( Ctrl * ctrl, char * buf, byte menuitem, byte, byte c )
+{
+  Relay * const relay = & ctrl->relays[c];
+  return relay->show( buf, menuitem, infoName( matrixIndex[relay->num()] ) );
+}
+
+static char const * showDays( Ctrl * ctrl, char * buf, byte menuitem, byte, byte c )
+{
+  return ctrl->relays[c].showDay( buf, menuitem );
+}
+
+static char const * showThres( Ctrl * ctrl, char * buf, byte menuitem, byte, byte )
+{
+  return ctrl->temp->showThres( buf, menuitem );
+}
+
+static char const * showHist( Ctrl * ctrl, char * buf, byte menuitem, byte, byte )
+{
+  return ctrl->temp->showHist( buf, menuitem );
+}
+
+static char const * showJour( Ctrl * ctrl, char * buf, byte menuitem, byte, byte )
+{
+  return ctrl->journal->show( buf, menuitem );
+}
+
+static char const * showValue( Ctrl * ctrl, char * buf, byte menuitem, byte, byte idx )
+{
+  return ctrl->temp->showValue( buf, menuitem, pgm_read_byte( & infoMatrix[idx].num ) );
+}
+
+// adjust items: the step is added to the setting every sec, when the item is shown
+// for more than 3 secs (limits checked here and by set() of the sub system)
+//
+//   |Ausz. +=01:00:00|  <- label, step  ("Limit erreicht", when not changed)
+//   |Auszeit:05:00:00|  <- name, value  (on refresh just the value field)
+
+enum FMT {     // print value and step
+  FMT_NUM = 0  // number
+ ,FMT_HMS      // secs as hh:mm:ss
+ ,FMT_MIN      // minutes as hh:mm:ss
+ ,FMT_DATE     // day of year as dd.mm. (step as number)
+ ,FMT_PCT      // luminance 0..Lumi::LUM_MAX as percent (step, min and max in percent)
+};
+enum OPT {     // values for opts
+  OPT_WRAP  = 1  // beyond a limit continue at the other one (otherwise stay)
+ ,OPT_KNOWN = 2  // item skipped, while value is negative (unknown)
+};
+
+struct menuVal {  // adjustable setting
+  char         label[7];  // 1st line
+  char         name[12];  // 2nd line
+  byte         sub;       // Ctrl::SUB (SUB_RELAY: arg of category added)
+  byte         par;       // PARAM of sub system
+  byte         fmt;       // FMT
+  byte         opts;      // OPT
+  long         min;
+  long         max;
+};
+
+enum VAL {  // index of valTable
+  VAL_TIMEOUT = 0
+ ,VAL_TIMEOFF
+ ,VAL_LUMSWITCH
+ ,VAL_LUMDAWN
+ ,VAL_PAUSING
+ ,VAL_B4START
+ ,VAL_RUNNING
+ ,VAL_B4STOP
+ ,VAL_CLOCK
+ ,VAL_DAY
+};
+
+static menuVal const valTable[] PROGMEM =
+{
+       { "Ausz. ", "Auszeit",                Ctrl::SUB_RELAY, Relay::PAR_TIMEOUT,  FMT_MIN,  0,
+         Relay::TIMEOUT_MIN, Relay::TIMEOUT_MAX }
+      ,{ "Absch.", "Absch.",                 Ctrl::SUB_LUMI,  Lumi::PAR_TIMEOFF,   FMT_HMS,  0,
+         -Lumi::TIMEOFF_MAX, Lumi::TIMEOFF_MAX }
+      ,{ "Schalt", "Schaltpunkt",            Ctrl::SUB_LUMI,  Lumi::PAR_LUMSWITCH, FMT_PCT,  0,
+         0, 100 }
+      ,{ "D" STR_AUML "mm. ", "D" STR_AUML "mmerung", Ctrl::SUB_LUMI, Lumi::PAR_LUMDAWN, FMT_PCT, 0,
+         0, 100 }
+      ,{ "Einst.", "Pause (ein)",            Ctrl::SUB_TEMP,  Temp::PAR_PAUSING,   FMT_NUM,  0,
+         0, Temp::PAR_MAX }
+      ,{ "Einst.", "Heute (ein)",            Ctrl::SUB_TEMP,  Temp::PAR_B4START,   FMT_NUM,  0,
+         0, Temp::PAR_MAX }
+      ,{ "Einst.", "l" STR_AUML "uft (aus)", Ctrl::SUB_TEMP,  Temp::PAR_RUNNING,   FMT_NUM,  0,
+         0, Temp::PAR_MAX }
+      ,{ "Einst.", "Heute (aus)",            Ctrl::SUB_TEMP,  Temp::PAR_B4STOP,    FMT_NUM,  0,
+         0, Temp::PAR_MAX }
+      ,{ "Zeit  ", "Uhrzeit",                Ctrl::SUB_LUMI,  Lumi::PAR_CLOCK,     FMT_HMS,  OPT_KNOWN,
+         -Lumi::SECCORR_MAX, 86399L + Lumi::SECCORR_MAX }  // limit by set(): secCorr
+      ,{ "Tag   ", "Datum",                  Ctrl::SUB_LUMI,  Lumi::PAR_DAY,       FMT_DATE, OPT_WRAP,
+         1, Sun::DAYS }
+};
+
+struct menuAdj {
+  byte         val;   // VAL
+  short        step;  // added to value (negative: decrease)
+};
+
+enum ADJ {  // 1st item of category in adjTable
+  ADJ_RELAY = 0
+ ,ADJ_DOWN  = ADJ_RELAY +  6
+ ,ADJ_THRES = ADJ_DOWN  + 10
+ ,ADJ_TIME  = ADJ_THRES +  8
+ ,ADJ_TIME_LEN = LATITUDE ? 14 : 10  // day just with the sunrise/sunset model
+};
+
+static menuAdj const adjTable[] PROGMEM =
+{
+       { VAL_TIMEOUT,     60 }, { VAL_TIMEOUT,     -60 }  // ADJ_RELAY
+      ,{ VAL_TIMEOUT,     10 }, { VAL_TIMEOUT,     -10 }
+      ,{ VAL_TIMEOUT,      1 }, { VAL_TIMEOUT,      -1 }
+      ,{ VAL_TIMEOFF,   3600 }, { VAL_TIMEOFF,   -3600 }  // ADJ_DOWN
+      ,{ VAL_TIMEOFF,    600 }, { VAL_TIMEOFF,    -600 }
+      ,{ VAL_TIMEOFF,     60 }, { VAL_TIMEOFF,     -60 }
+      ,{ VAL_LUMSWITCH,   10 }, { VAL_LUMSWITCH,   -10 }
+      ,{ VAL_LUMDAWN,     10 }, { VAL_LUMDAWN,     -10 }
+      ,{ VAL_PAUSING,      1 }, { VAL_PAUSING,      -1 }  // ADJ_THRES
+      ,{ VAL_B4START,      1 }, { VAL_B4START,      -1 }
+      ,{ VAL_RUNNING,      1 }, { VAL_RUNNING,      -1 }
+      ,{ VAL_B4STOP,       1 }, { VAL_B4STOP,       -1 }
+      ,{ VAL_CLOCK,     3600 }, { VAL_CLOCK,     -3600 }  // ADJ_TIME
+      ,{ VAL_CLOCK,      600 }, { VAL_CLOCK,      -600 }
+      ,{ VAL_CLOCK,       60 }, { VAL_CLOCK,       -60 }
+      ,{ VAL_CLOCK,       10 }, { VAL_CLOCK,       -10 }
+      ,{ VAL_CLOCK,        1 }, { VAL_CLOCK,        -1 }
+#if LATITUDE
+      ,{ VAL_DAY,         10 }, { VAL_DAY,         -10 }
+      ,{ VAL_DAY,          1 }, { VAL_DAY,          -1 }
+#endif
+};
+static_assert( NELEMENTS(adjTable) == ADJ_TIME + ADJ_TIME_LEN, "adjTable does not match ADJ" );
+
+static word const monthStart[] PROGMEM = { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 };
+
+static byte percent( long lum )  // luminance 0..Lumi::LUM_MAX -> 0..100
+{
+  return (((lum * 25) + 0x80) >> 8) & 0x7f;
+}
+
+static void field( char * end, byte fmt, long val )  // print val right aligned in front of end
+{
+  switch (fmt) {
+    case FMT_HMS:
+      Display::hms( end - 8, val );
+      break;
+    case FMT_MIN:
+      Display::hms( end - 8, val * 60 );
+      break;
+    case FMT_DATE:
+      if (val) {
+        byte m = 11;
+        while (val <= pgm_read_word( & monthStart[m] ))
+          --m;
+        Display::itoa( end - 6, 3, val - pgm_read_word( & monthStart[m] ) );
+        end[-4] = '.';
+        Display::itoa( end - 3, 3, m + 1 );
+        end[-1] = '.';
+      } else
+        memcpy_P( end - 6, PSTR( "unbek." ), 6 );
+      break;
+    case FMT_PCT:
+      Display::itoa( end - 4, 4, val );
+      end[-1] = '%';
+      break;
+    default:
+      {
+        char num[7];
+        char const * cp = Display::itoa( num, sizeof(num), val );
+        memcpy( end - (num + 6 - cp), cp, num + 6 - cp );
+      }
+  }
+}
+
+static char const hdrIntro[] PROGMEM = "|gelb: next cat. |blau: next item |";
+static char const hdrSys[]   PROGMEM = "|Systemwerte     |anzeigen";
+static char const hdrTime[]  PROGMEM = "|Uhrzeit         |anzeigen";
+static char const hdrDown[]  PROGMEM = "|D" STR_AUML "mmerungswerte |anzeigen";
+static char const hdrLamp[]  PROGMEM = "|Einschaltzeiten |Bel. anzeigen";
+static char const hdrPump[]  PROGMEM = "|Einschaltzeiten |Pumpe anzeigen";
+static char const hdrLDays[] PROGMEM = "|Bel.: letzte    |Tage            |";
+static char const hdrPDays[] PROGMEM = "|Pumpe: letzte   |Tage            |";
+static char const hdrThres[] PROGMEM = "|Temperatur-     |Differenz-Werte |";
+static char const hdrHist[]  PROGMEM = "|Pumpe: letzte   |Entscheidungen  |";
+static char const hdrJour[]  PROGMEM = "|Ereignis-       |Protokoll       |";
+
+static menuCat const menuTable[] PROGMEM =
+{
+       { hdrIntro, 0,         0,             0, 0,         0            }
+      ,{ hdrSys,   showSys,   0,             0, 0,         0            }
+      ,{ hdrTime,  showTime,  0,             1, ADJ_TIME,  ADJ_TIME_LEN }
+      ,{ hdrDown,  showDown,  0,             3, ADJ_DOWN,  10           }
+      ,{ hdrLamp,  showRelay, Circuit::LAMP, 4, ADJ_RELAY, 6            }
+      ,{ hdrPump,  showRelay, Circuit::PUMP, 4, ADJ_RELAY, 6            }
+      ,{ hdrLDays, showDays,  Circuit::LAMP, 0, 0,         0            }
+      ,{ hdrPDays, showDays,  Circuit::PUMP, 0, 0,         0            }
+      ,{ hdrThres, showThres, 0,             1, ADJ_THRES, 8            }
+      ,{ hdrHist,  showHist,  0,             0, 0,         0            }
+      ,{ hdrJour,  showJour,  0,             0, 0,         0            }
+      ,{ 0,        showValue, 0,             0, 0,         0            }  // infoMatrix index of temperatures
+      ,{ 0,        showValue, 1,             0, 0,         0            }
+      ,{ 0,        showValue, 2,             0, 0,         0            }
+      ,{ 0,        showValue, 3,             0, 0,         0            }
+      ,{ 0,        showValue, 4,             0, 0,         0            }
+};
+
 Display::Display()
  : flags( FLAG_ON | FLAG_MENU )
 {
 }
 
-void Display::setup( Ctrl * ctrlArg, LiquidCrystal * lcdArg )
+void Display::setup( Ctrl * ctrlArg, Lcd * lcdArg )
 {
   ctrl = ctrlArg;
   lcd = lcdArg;
 
   for (byte idx = 0; idx < NELEMENTS(infoMatrix); ++idx)
-    matrixIndex[infoMatrix[idx].num] = idx;
+    matrixIndex[pgm_read_byte( & infoMatrix[idx].num )] = idx;
 
   timeout = millis() + (5 _k); // initial switch to info mode
   if (! timeout) timeout = 1;  // jump over "permanent on" indicaton
   lcd->display();
-  lcd->noCursor();
   lcd->clear();
   cursor = 0;
+  memset( shown, ' ', 0x20 );
+  lcdpos = 0;
 
-  strcpy( menucont, "|Piscino " VERSION "       " ); // VERSION must be macro
-  strcpy( & menucont[0x11],          "|Holger Galuschka|" );
-  strcpy( infocont, "|                |                |" );
+  strcpy_P( menucont, PSTR( "|Piscino " VERSION "       " ) ); // VERSION must be macro
+  strcpy_P( & menucont[0x11],          PSTR( "|Holger Galuschka|" ) );
+  strcpy_P( infocont, PSTR( "|                |                |" ) );
 
   memset( check, '$', 7 ); check[7] = 0;
   memset( hint, 0, 0x10 );
@@ -70,12 +328,19 @@ void Display::setup( Ctrl * ctrlArg, LiquidCrystal * lcdArg )
 
 void Display::showcont( char const * cont )
 {
-//lcd->clear();
-  lcd->home();
-  lcd->print( cont + 1 );
-  lcd->setCursor( 0, 1 );
-  lcd->print( cont + 0x12 );
-//lcd->setCursor( cursor & 0xf, cursor >> 4 );
+  for (byte pos = 0; pos < 0x20; ++pos) {
+    char const c = cont[pos + 1 + (pos >> 4)];
+    if (shown[pos] == c)
+      continue;
+
+    if (lcdpos != pos)  // not contiguous to last written char
+      lcd->setCursor( pos & 0xf, pos >> 4 );
+    lcd->write( (uint8_t) c );
+    shown[pos] = c;
+
+    // behind end of line, LCD cursor is not at next line
+    lcdpos = ((pos + 1) & 0xf) ? (pos + 1) : 0xff;
+  }
 }
 
 void Display::dumpcont(void)
@@ -89,27 +354,21 @@ void Display::dumpcont(void)
       continue;
     flags &= ~(FLAG_INFO_CHANGED << i);
 
-    Serial.print( "    LCD " );
-    Serial.print( i ? "menu: " : "info: " );
-    char * cont = i ? menucont : infocont;
-    byte x = cont[0x23]; // expected to be 0
-    cont[0x23] = 0;
-    Serial.print( cont );
+    char * const cont = i ? menucont : infocont;
+    char rows[0x20];
+    memcpy( rows,        cont + 1,    0x10 );
+    memcpy( rows + 0x10, cont + 0x12, 0x10 );
+    Log::put( i ? Log::MSG_LCD_MENU : Log::MSG_LCD_INFO, rows, 0x20 );
     if ((! i) && hint[0]) {
-      Serial.print( " (here: \"" );
-      Serial.print( hint );
-      Serial.print( "\")" );
+      Log::put( Log::MSG_LCD_HINT, hint, strnlen( hint, 0xf ) );
       hint[0] = 0;
     }
-    if (x) {
-      Serial.print( " oops: \"" );
-      cont[0x23] = x;
-      check[7] = 0;
-      Serial.print( cont + 0x23 );
+    if (cont[0x23]) {  // expected to be 0
+      Log::put( Log::MSG_LCD_OOPS, cont + 0x23, 7 );
       cont[0x23] = 0;
       memset( check, '$', 7 );
+      check[7] = 0;
     }
-    Serial.println();
   }
 #endif
 }
@@ -160,36 +419,33 @@ void Display::info( byte num, short val )
   if (num >= NUM_COUNT)
     return;
 
-  infoPos const * pos = & infoMatrix[ matrixIndex[num] ];
+  infoPos info;
+  memcpy_P( & info, & infoMatrix[ matrixIndex[num] ], sizeof(info) );
+  infoPos const * pos = & info;
   if (! pos->len)  // not to show box temp. (shown in menu)
     return;
 
   char buf[8];
   char * cp;
   char * ep;
-  switch (num) {
-    case NUM_PUMP:
-    case NUM_LAMP:
-      cp = ep = & buf[1];
+  if (num > NUM_LUM) {  // relay: val is Switch::MODE | autoon << 2 | on << 3
+    cp = ep = & buf[1];
+    *++ep = 0;
+    switch (val & 3) {
+      case Switch::OFF:  *cp = 'O'; break;
+      case Switch::ON:   *cp = 'I'; break;
+      case Switch::AUTO: *cp = 'A'; break;
+      case Switch::TEMP: *cp = 'T'; break;
+    }
+    *cp  |=             ((~val << 3) & 0x20);  // lower case, when "auto:off"
+    *--cp = pos->abbr | ((~val << 2) & 0x20);  // lower case, when "off"
+  } else {
+    cp = itoa( buf, sizeof(buf) - 1, val );
+    ep =     & buf[ sizeof(buf) - 2 ];
+    if (num != NUM_LUM) {
+      *ep = CHR_DEGREE;
       *++ep = 0;
-      switch (val & 3) {
-        case Switch::OFF:  *cp = 'O'; break;
-        case Switch::ON:   *cp = 'I'; break;
-        case Switch::AUTO: *cp = 'A'; break;
-        case Switch::TEMP: *cp = 'T'; break;
-      }
-      *cp  |=             ((~val << 3) & 0x20);  // lower case, when "auto:off"
-      *--cp = pos->abbr | ((~val << 2) & 0x20);  // lower case, when "off"
-      break;
-
-    default:
-      cp = itoa( buf, sizeof(buf) - 1, val );
-      ep =     & buf[ sizeof(buf) - 2 ];
-      if (num != NUM_LUM) {
-        *ep = CHR_DEGREE;
-        *++ep = 0;
-      }
-      break;
+    }
   }
 
   byte len = ep - cp;
@@ -202,11 +458,9 @@ void Display::info( byte num, short val )
     memcpy( & infocont[pos->pos + 1 + (pos->pos >> 4)], cp, len );
     strncpy( hint, cp, 0xf );
     flags |= FLAG_INFO_CHANGED;
-  }
 
-  if ((flags & (FLAG_ON|FLAG_MENU)) == FLAG_ON) {
-    lcd->setCursor( pos->pos & 0xf, pos->pos >> 4 );
-    lcd->print( cp );
+    if ((flags & (FLAG_ON|FLAG_MENU)) == FLAG_ON)
+      showcont( infocont );
   }
 }
 
@@ -219,7 +473,8 @@ void Display::toggleMode(void)
 {
   flags ^= FLAG_MENU;
   if (flags & FLAG_MENU) {
-    menunum = 0;
+    menucat  = 0;
+    menuitem = 0;
     refresh( 1 );
   } else {
     if (flags & FLAG_ON)
@@ -229,82 +484,149 @@ void Display::toggleMode(void)
   restart();
 }
 
-void Display::key( byte num )
+void Display::key( byte key )
 {
-  if (num == NUM_LAMP)
-    menunum = (menunum + 0x10) & 0xf0;
-  else
-    menunum = (menunum & 0xf0) | ((menunum + 1) & 0xf);
+  if (key == KEY_CAT) {
+    ++menucat;
+    menuitem = 0;
+  } else
+    ++menuitem;
 
   refresh( 1 );
   restart();
 }
 
+boolean Display::adjust( byte init )
+{
+  if (init)
+    secEnter = ctrl->sec;
+  return (! init) && (ctrl->sec > (secEnter + 3));
+}
+
+char const * Display::showAdjust( char * buf, byte idx, byte arg, byte init )
+{
+  menuAdj adj;
+  memcpy_P( & adj, & adjTable[idx], sizeof(adj) );
+  menuVal v;
+  memcpy_P( & v, & valTable[adj.val], sizeof(v) );
+  if (v.sub == Ctrl::SUB_RELAY)
+    v.sub += arg;
+
+  long val = ctrl->get( v.sub, v.par );
+  if ((v.opts & OPT_KNOWN) && (val < 0))
+    return 0;
+
+  byte const len = strlen( v.name );
+  if (init) {
+    memset( buf + 1, ' ', 0x21 );
+    buf[   0] = '|';
+    buf[0x11] = '|';
+    buf[0x22] = '|';
+    buf[0x23] = 0;
+    memcpy( buf + 1, v.label, 6 );
+    buf[7] = (adj.step < 0) ? '-' : '+';
+    buf[8] = '=';
+    field( buf + 0x11, (v.fmt == FMT_DATE) ? FMT_NUM : v.fmt, (adj.step < 0) ? -adj.step : adj.step );
+    buf[0x11] = '|';  // overwritten by hms()
+    memcpy( buf + 0x12, v.name, len );
+    buf[0x12 + len] = ':';
+  } else
+    memcpy( buf, menucont, sizeof(menucont) );  // just fields to change
+
+  if (adjust( init )) {
+    long next = val + adj.step;
+    if (v.fmt == FMT_PCT) {  // steps snap to multiples of step, 1% steps next to 0 and 100%
+      byte const coarse = (adj.step < 0) ? -adj.step : adj.step;
+      next = percent( val ) + adj.step;
+      if ((next < coarse) || (next > (100 - coarse)))
+        next = percent( val ) + ((adj.step < 0) ? -1 : 1);
+      else
+        next = ((next + (coarse / 2)) / coarse) * coarse;
+    }
+    if (next < v.min)
+      next = (v.opts & OPT_WRAP) ? next + (v.max - v.min + 1) : v.min;
+    else if (next > v.max)
+      next = (v.opts & OPT_WRAP) ? next - (v.max - v.min + 1) : v.max;
+    if (v.fmt == FMT_PCT)
+      next = ((next << 8) + 12) / 25;
+
+    if ((next == val) || ! ctrl->set( v.sub, v.par, next ))
+      memcpy_P( buf + 1, PSTR( "Limit erreicht  " ), 16 );
+    else
+      val = ctrl->get( v.sub, v.par );
+  } else if ((! init) && (val == adjShown))
+    return 0;  // no refresh neccessary
+
+  adjShown = val;
+  memset( buf + 0x13 + len, ' ', 0x0f - len );
+  field( buf + 0x22, v.fmt, (v.fmt == FMT_PCT) ? percent( val ) : val );
+  buf[0x22] = '|';
+  return buf;
+}
+
 void Display::refresh( byte init )
 {
-  char const * ccp = 0;
-  char * cp = 0;
+  char const * ccp;
   char buf[0x24];
 
-  do
+  Ctrl::crumb = Ctrl::CRUMB_DISPLAY;
+
+  for (;;)
   {
-    // Serial.print( "   menunum: " );
-    // Serial.println( itox( buf, sizeof(buf), menunum ) );
-
-    if (! (menunum & 0xf)) {
-      if (! init)
-        return;
-      switch (menunum >> 4) {
-        case 0: ccp = "|gelb: next cat. |blau: next item |"; break;
-        case 1: ccp = "|Systemwerte     |anzeigen";          break;
-        case 2: ccp = "|Uhrzeit         |anzeigen";          break;
-        case 3: ccp = "|D" STR_AUML
-                         "mmerungswerte |anzeigen";          break;
-        case 4: ccp = "|Einschaltzeiten |Bel. anzeigen";     break;
-        case 5: ccp = "|Einschaltzeiten |Pumpe anzeigen";    break;
-
-        case 6: ccp = "|Temperatur-     |Differenz-Werte |"; break;
-        default:
-                if (menunum >= ((7 + NUM_TEMP) << 4))
-                  break;
-
-                strcpy( buf, "|Temperatur-Werte|\"" );
-                cp = strchr( buf, 0 );
-                strcpy( cp, infoMatrix[ (menunum >> 4) - 7 ].name );
-                cp = strchr( cp, 0 );
-                *cp = '"';
-                *++cp = 0;
-                cp = buf;
-                break;
-      }
-    } else {
-      switch (menunum >> 4) {
-        case 0: menunum = 0x10; break;  // next cat. also with blue key (just in intro)
-        case 1: ccp = ctrl->show(            buf, menunum & 0xf, init ); break;
-        case 2: ccp = ctrl->lumi->showTime(  buf, menunum & 0xf, init ); break;
-        case 3: ccp = ctrl->lumi->showDown(  buf, menunum & 0xf, init ); break;
-        case 4: ccp = ctrl->lampRelay->show( buf, menunum & 0xf, init, infoMatrix[ matrixIndex[NUM_LAMP] ].name ); break;
-        case 5: ccp = ctrl->pumpRelay->show( buf, menunum & 0xf, init, infoMatrix[ matrixIndex[NUM_PUMP] ].name ); break;
-        case 6:  cp = ctrl->temp->showThres( buf, menunum & 0xf, init                                 ); break;
-        default: cp = ctrl->temp->showValue( buf, menunum & 0xf, infoMatrix[ (menunum >> 4) - 7 ].num ); break;
-      }
+    byte const item = menuitem;
+    byte       skip = 0;  // no info of this item: next item
+    ccp = 0;
+
+    if (menucat < NELEMENTS(menuTable)) {
+      menuCat entry;
+      memcpy_P( & entry, & menuTable[menucat], sizeof(entry) );
+
+      if (! item) {
+        if (! init)
+          return;
+        if (entry.header)
+          ccp = strcpy_P( buf, entry.header );
+        else {  // header with long name of the info
+          strcpy_P( buf, PSTR( "|Temperatur-Werte|\"" ) );
+          char * cp = strchr( buf, 0 );
+          strcpy_P( cp, infoName( entry.arg ) );
+          cp = strchr( cp, 0 );
+          *cp = '"';
+          *++cp = 0;
+          ccp = buf;
+        }
+      } else if (! entry.show) {
+        menucat  = 1;  // next cat. also with blue key (just in intro)
+        menuitem = 0;
+        continue;
+      } else if (item <= entry.info) {
+        ccp = entry.show( ctrl, buf, item, init, entry.arg );
+        skip = 1;
+      } else if (item <= entry.info + entry.adjLen) {
+        ccp = showAdjust( buf, entry.adj + item - entry.info - 1, entry.arg, init );
+        skip = 1;
+      } else
+        ccp = entry.show( ctrl, buf, item - entry.adjLen, init, entry.arg );
     }
 
-    if (! ccp)
-      if (! (ccp = cp)) {  // no info
-        if (! init)  // just refresh
-          return;    // no refresh neccessary
+    if (ccp)
+      break;
 
-        // init but no info: restart at first item (rotate)
-        if (menunum & 0xf) // no item info
-          menunum &= 0xf0; // header of this cat.
-        else               // no header info -> end of menu -> restart with 1st cat.
-          menunum = 0x10;  // skip "intro" (gelb: next cat. / blau: next item)
-      }
-  } while (! ccp);
+    // no info
+    if (! init)  // just refresh
+      return;    // no refresh neccessary
+
+    // init but no info: next item or restart at first item (rotate)
+    if (skip)            // info or adjust item skipped (e.g. time unknown)
+      ++menuitem;
+    else if (item)       // no item info
+      menuitem = 0;      // header of this cat.
+    else                 // no header info -> end of menu -> restart with 1st cat.
+      menucat  = 1;      // skip "intro" (gelb: next cat. / blau: next item)
+  }
 
   byte len = strlen(ccp);
-  cp = menucont;
+  char * cp = menucont;
   byte max = 0x22;
   if (*ccp != '|') {
     ++cp;
@@ -322,23 +644,63 @@ void Display::refresh( byte init )
   }
 }
 
+// no hardware divider on AVR: divide by constants by multiplication with reciprocal
+// (magic numbers and shifts are exact for all 32 bit values)
+// the product is built from 16 x 16 bit multiplies (MUL): no 64 bit arithmetic
+
+static byte div10( word & val )  // val /= 10 / return: remainder (exact for 16 bit)
+{
+  word const q = ((unsigned long) val * 0xcccdU) >> 19;
+  byte const r = val - (q * 10);
+  val = q;
+  return r;
+}
+
+static unsigned long mulhi( unsigned long x, unsigned long m )  // upper 32 bit of x * m
+{
+  word const          xl  = x;
+  word const          xh  = x >> 16;
+  word const          ml  = m;
+  word const          mh  = m >> 16;
+  unsigned long const lh  = (unsigned long) xl * mh;
+  unsigned long const hl  = (unsigned long) xh * ml;
+  unsigned long const mid = (((unsigned long) xl * ml) >> 16) + (word) lh + (word) hl;  // < 3 * 2^16
+  return ((unsigned long) xh * mh) + (lh >> 16) + (hl >> 16) + (mid >> 16);
+}
+
+#define divm( x, magic, shift )  (mulhi( (x), (magic) ) >> ((shift) - 32))
+
+#define DIV24(x)     divm( (x), 0xaaaaaaabUL, 36 )
+#define DIV60(x)     divm( (x), 0x88888889UL, 37 )
+#define DIV100(x)    divm( (x), 0x51eb851fUL, 37 )
+#define DIV3600(x)   divm( (x), 0x91a2b3c5UL, 43 )
+#define DIV10000(x)  divm( (x), 0xd1b71759UL, 45 )
+#define DIV86400(x)  divm( (x), 0xc22e4507UL, 48 )
+
+static word quot14( unsigned long num, unsigned long den )  // num / den, when less than 2^14
+{
+  word q = 0;
+  for (byte bit = 14; bit--; )
+    if ((num >> bit) >= den) {
+      num -= den << bit;
+      q   |= 1 << bit;
+    }
+  return q;
+}
+
 char * Display::itoa( char * buf, int bufsize, int digit )  // bufsize: incl. \0
 {
-  byte neg = 0;
-  if (digit < 0) {
-    digit = -digit;
-    neg = 1;
-  }
+  word val = (digit < 0) ? -digit : digit;
 
   char * cp = & buf[bufsize - 1];
   *cp = 0;
 
   do {
-    *--cp = (digit % 10) ? (digit % 10) + '0' : 'O';  // o more readable than 0 (similar to 8 on LCD)
-    digit /= 10;
-  } while (digit);
+    byte const d = div10( val );
+    *--cp = d ? d + '0' : 'O';  // o more readable than 0 (similar to 8 on LCD)
+  } while (val);
 
-  if (neg)
+  if (digit < 0)
     *--cp = '-';
 
   return cp;
@@ -359,54 +721,63 @@ char * Display::itox( char * buf, int bufsize, int digit )  // bufsize: incl. \0
 
 char * Display::hms( char * buf, signed long secs )  // print "hh:mm:ss"
 {
-  secs = (secs + 345600L) % 86400L;  // add 4 days and use remainder to one day
+  secs += 345600L;  // add 4 days and use remainder to one day
+  unsigned long const abs = (secs < 0) ? -secs : secs;
+  unsigned long day = abs - (DIV86400( abs ) * 86400L);
+  word const h = DIV3600( day ); day -= h * 3600L;
+  word const m = DIV60( day );   day -= m * 60;
+  int  const sign = (secs < 0) ? -1 : 1;  // remainder has sign of secs (as '%')
+
   buf[0] = ' ';
-  itoa( buf + 0, 3, secs / 3600L ); secs %= 3600L;
+  itoa( buf + 0, 3, sign * (int) h );
   buf[2] = ':';
   buf[3] = 'O';
-  itoa( buf + 3, 3, secs / 60 );
+  itoa( buf + 3, 3, sign * (int) m );
   buf[5] = ':';
   buf[6] = 'O';
-  itoa( buf + 6, 3, secs % 60 );
+  itoa( buf + 6, 3, sign * (int) day );
   return buf;
 }
 
 char * Display::dhms( char * buf, unsigned long secs )  // print "ddddd d", "dd;hh d", "hh:mm h" or "mm:ss m"
 {
   if (secs <= 3600L) {  // mm:ss
+    word const m = DIV60( secs );
     buf[0] = ' ';
-    itoa( buf, 3, secs / 60 );
+    itoa( buf, 3, m );
     buf[2] = ':';
     buf[3] = 'O';
-    itoa( buf + 3, 3, secs % 60 );
+    itoa( buf + 3, 3, secs - (m * 60) );
     buf[5] = ' ';
     buf[6] = 'm';
     return buf;
   }
 
   secs += 30;  // round minutes
-  unsigned long mins = secs / 60L;
+  unsigned long mins = DIV60( secs );
 
   if (mins <= (48 * 60)) {  // hh:mm
+    word const h = DIV60( mins );
     buf[0] = ' ';
-    itoa( buf, 3, mins / 60 );
+    itoa( buf, 3, h );
     buf[2] = ':';
     buf[3] = 'O';
-    itoa( buf + 3, 3, mins % 60 );
+    itoa( buf + 3, 3, mins - (h * 60) );
     buf[5] = ' ';
     buf[6] = 'h';
     return buf;
   }
 
   mins += 30;  // round hours
-  unsigned long hours = mins / 60L;
+  unsigned long hours = DIV60( mins );
 
   if (hours < (2400)) {  // dd;hh
+    word const d = DIV24( hours );
     buf[0] = ' ';
-    itoa( buf, 3, hours / 24 );
+    itoa( buf, 3, d );
     buf[2] = ';';
     buf[3] = 'O';
-    itoa( buf + 3, 3, hours % 24 );
+    itoa( buf + 3, 3, hours - (d * 24) );
     buf[5] = ' ';
     buf[6] = 'd';
     return buf;
@@ -414,7 +785,7 @@ char * Display::dhms( char * buf, unsigned long secs )  // print "ddddd d", "dd;
 
   hours += 12;  // round days
   memset( buf, ' ', 4 );
-  itoa( buf, 6, hours / 24L );
+  itoa( buf, 6, DIV24( hours ) );
   buf[5] = ' ';
   buf[6] = 'd';
   return buf;
@@ -427,24 +798,25 @@ char * Display::kelvin( char * buf, int rawtemp )  // print " x,y"
     rawtemp = -rawtemp;
     sign = -1;
   }
-  int k10 = ((rawtemp * 10) + 8) >> 4;
+  word k = ((rawtemp * 10) + 8) >> 4;
+  byte const d = div10( k );
   buf[0] = ' ';
-  char * ret = itoa( buf, 3, sign * (k10 / 10) );
+  char * ret = itoa( buf, 3, sign * (int) k );
   buf[2] = ',';
-  buf[3] = (k10 % 10) ? (k10 % 10) + '0' : 'O';
+  buf[3] = d ? d + '0' : 'O';
   return ret;
 }
 
 char * Display::percentage( char * buf, unsigned long val, unsigned long max )  // print "xx,yy %"
 {
-  unsigned int rel = 10000;
+  word rel = 10000;
   if (max && (val < max)) {
     if (val < (0xffffffffL / 10000L))
-      rel = ((val * 10000L) + (max / 2)) / max;
+      rel = quot14( (val * 10000L) + (max / 2), max );
     else if (val < (0xffffffffL / 100L))
-      rel = (val * 100L) / ((max + 50L) / 100L);
+      rel = quot14( val * 100L, DIV100( max + 50L ) );
     else
-      rel = val / ((max + 5000L) / 10000L);
+      rel = quot14( val, DIV10000( max + 5000L ) );
   }
 
   if (max  < 10000) {
@@ -455,12 +827,15 @@ char * Display::percentage( char * buf, unsigned long val, unsigned long max )
   }
 
   if (rel >= 10000) {
-    memcpy( buf, "1OO   %", 7 );
+    memcpy_P( buf, PSTR( "1OO   %" ), 7 );
     return buf;
   }
 
+  byte const lo = div10( rel );
+  byte const hi = div10( rel );  // rel: percent
+
   buf[0] = ' ';
-  char * ret = itoa( buf, 3, rel / 100 );
+  char * ret = itoa( buf, 3, rel );
 
   if (max < 1000) {
     buf[2] = ' ';
@@ -469,7 +844,7 @@ char * Display::percentage( char * buf, unsigned long val, unsigned long max )
   } else {
     buf[2] = ',';
     buf[3] = 'O';
-    itoa( buf + 3, 3, rel % 100 );
+    itoa( buf + 3, 3, (hi * 10) + lo );
     if (max < 10000)
       buf[4] = ' ';
   }
@@ -494,11 +869,8 @@ void Display::print( char const * str )
   strncpy( hint, str, 0xf );
   flags |= FLAG_MENU_CHANGED;
 
-  if ((flags & (FLAG_ON|FLAG_MENU)) == (FLAG_ON|FLAG_MENU)) {
-    lcd->print( str );
-    if (cursor == 0x10)
-      lcd->setCursor( 0, 1 );
-  }
+  if ((flags & (FLAG_ON|FLAG_MENU)) == (FLAG_ON|FLAG_MENU))
+    showcont( menucont );
 }
 
 void Display::print( int digit )
@@ -509,7 +881,6 @@ void Display::print( int digit )
 
 void Display::printat( byte col, byte row, char const * str )
 {
-  lcd->setCursor( col, row );
   cursor = (row << 4) | col;
   print( str );
 }
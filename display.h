@@ -2,8 +2,8 @@
 #define Display_h
 
 #include <Arduino.h>
-#include <LiquidCrystal.h>
 #include "ctrl.h"
+#include "lcd.h"
 
 
 class Display
@@ -17,12 +17,18 @@ class Display
      ,NUM_BOX
 
      ,NUM_LUM   // liminance / lightness
-     ,NUM_LAMP  // off, on, auto (off), auto (on)
-     ,NUM_PUMP  // off, on, auto (off), auto (on)
+
+     ,NUM_LAMP  // relays behind NUM_LUM: off, on, auto (off), auto (on)
+     ,NUM_PUMP
 
      ,NUM_COUNT
      ,NUM_TEMP = NUM_LUM
     };
+    enum KEY {  // menu control by switches (see circuit.h)
+      KEY_NONE = 0
+     ,KEY_ITEM  // next item
+     ,KEY_CAT   // next category
+    };
     enum FLAGS {  // values for flags
       FLAG_ON           = 1
      ,FLAG_MENU         = 2  // menu mode - no info output, but normal output
@@ -34,18 +40,23 @@ class Display
     long    timeout;        // to switch back to info or to switch off
     byte    flags;          // on/off, info/menu, ...
     byte    cursor;         // 0x20: row, 0x1f: col
-    byte    menunum;        // menu status
+    byte    menucat;        // menu category (index of menuTable)
+    byte    menuitem;       // item of menucat (0: header)
     char    menucont[0x24]; // |...|...| 0..0f: 1st line, 11..20: 2nd line, 10,21: |
     char    infocont[0x24]; // |L:22° B:32° H:50|W:28° S:45° PABA|
     char    check[0x8];     // check overwrites
     char    hint[0x10];     // hint for change
+    unsigned long secEnter; // ctrl->sec, when we did enter the menu item
+    long    adjShown;       // value shown by adjust item
+    char    shown[0x20];    // shadow of LCD content (0..0f: 1st line, 10..1f: 2nd line)
+    byte    lcdpos;         // LCD cursor as in shown[] (0xff: unknown)
 
-    LiquidCrystal * lcd;
-    Ctrl          * ctrl;
+    Lcd     * lcd;
+    Ctrl    * ctrl;
 
   public:
     Display();
-    void setup( Ctrl * ctrl, LiquidCrystal * lcd );
+    void setup( Ctrl * ctrl, Lcd * lcd );
     void secLoop(void);
 
     void refresh( byte init );  // init or refresh menu content
@@ -53,7 +64,7 @@ class Display
 
     void    toggleMode(void);   // toggle menu/info mode
     boolean menu(void);         // true: we are in menu mode
-    void    key( byte num );    // menu control with lamp and pump key
+    void    key( byte key );    // menu control (KEY)
 
     static char * itoa(       char * buf, int bufsize, int digit );  // bufsize: incl. \0
     static char * itox(       char * buf, int bufsize, int digit );  // bufsize: incl. \0
@@ -70,7 +81,10 @@ class Display
     void printat( byte col, byte row, char const * str );
     void printat( byte col, byte row, int digit );
 
-    void showcont( char const * cont );  // show on LCD
+    boolean adjust( byte init );  // true: adjust value of menu item now (every sec after 3 secs)
+    char const * showAdjust( char * buf, byte idx, byte arg, byte init );  // adjust item (index of adjTable)
+
+    void showcont( char const * cont );  // show on LCD (just changed chars)
     void dumpcont(void);                 // show on serial
 };
 
@@ -0,0 +1,76 @@
+#include "events.h"
+#include "circuit.h"    // Circuits<>::autoOn(), Circuits<>::newDay()
+#include "temp.h"       // Temp::night()
+
+Events::Events()
+  : head( 0 )
+  , qlen( 0 )
+{
+}
+
+void Events::setup( Ctrl * ctrlArg )
+{
+  ctrl = ctrlArg;
+}
+
+void Events::post( byte type, byte arg, short val )
+{
+  for (byte i = 0; i < qlen; ++i) {
+    event & e = queue[(head + i) % QUEUE_LEN];
+    if ((e.type == type) && (e.arg == arg)) {
+      e.val = val;  // coalesce: pending event gets the new value
+      return;
+    }
+  }
+
+  while (qlen >= QUEUE_LEN)
+    deliver();  // not expected: make room
+
+  event & e = queue[(head + qlen++) % QUEUE_LEN];
+  e.type = type;
+  e.arg  = arg;
+  e.val  = val;
+}
+
+void Events::dispatch(void)
+{
+  for (byte n = DISPATCH_PER_LOOP; n && qlen; --n)
+    deliver();
+}
+
+void Events::flush(void)
+{
+  while (qlen)
+    deliver();  // may post further events
+}
+
+void Events::deliver(void)
+{
+  event const e = queue[head];  // copy: delivery may post
+  head = (head + 1) % QUEUE_LEN;
+  --qlen;
+
+  switch (e.type) {
+    case EV_INFO:
+      ctrl->display->info( e.arg, e.val );
+      break;
+
+    case EV_AUTO:
+      if (e.arg == Circuit::SRC_TEMP)
+        Circuits<>::autoOn<Circuit::SRC_TEMP>( ctrl, e.val );
+      else if (e.arg == Circuit::SRC_LUMI)
+        Circuits<>::autoOn<Circuit::SRC_LUMI>( ctrl, e.val );
+      break;
+
+    case EV_NEW_DAY:
+      if (e.arg == Circuit::REF_DAWN)
+        Circuits<>::newDay<Circuit::REF_DAWN>( ctrl );
+      else
+        Circuits<>::newDay<Circuit::REF_DUSK>( ctrl );
+      break;
+
+    case EV_NIGHT:
+      ctrl->temp->night( e.val );
+      break;
+  }
+}
@@ -0,0 +1,60 @@
+#ifndef Events_h
+#define Events_h
+
+#include <Arduino.h>
+#include "ctrl.h"
+#include "display.h"
+
+// side effects posted by producers and delivered later in loop()
+//
+// Temp (between OneWire steps), Lumi and the relays post an event instead of calling
+// into Display, Relay or Temp: dispatch() delivers at most DISPATCH_PER_LOOP events
+// per loop() pass, oldest first
+//
+// a pending event of the same type and arg is updated instead of queued again
+// (e.g. a temperature changed twice is shown once, the lamp switched on and off
+// again before delivery is not switched at all)
+//
+//   EV_INFO      arg: Display::NUM       val: value              Display::info()
+//   EV_AUTO      arg: Circuit::SOURCE    val: 1: on / 0: off     relays of source: Relay::autoOn()
+//   EV_NEW_DAY   arg: Circuit::REF       val: 0                  relays of ref: Relay::newDay()
+//   EV_NIGHT     arg: 0                  val: 1: dusk / 0: dawn  Temp::night()
+
+class Events
+{
+  public:
+    enum EV {
+      EV_INFO = 0
+     ,EV_AUTO
+     ,EV_NEW_DAY
+     ,EV_NIGHT
+    };
+
+  private:
+    enum {
+      QUEUE_LEN         = Display::NUM_COUNT + 5  // one per type and arg: never full
+     ,DISPATCH_PER_LOOP = 2
+    };
+
+    struct event {
+      byte      type;  // EV
+      byte      arg;
+      short     val;
+    };
+
+    event     queue[QUEUE_LEN];
+    byte      head;  // oldest event
+    byte      qlen;  // events pending
+    Ctrl    * ctrl;
+
+    void      deliver(void);  // oldest event
+
+  public:
+    Events();
+    void    setup( Ctrl * ctrl );
+    void    post( byte type, byte arg, short val = 0 );
+    void    dispatch(void);  // called every loop(): deliver a few pending events
+    void    flush(void);     // deliver all pending events (e.g. before backup)
+};
+
+#endif
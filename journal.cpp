@@ -0,0 +1,151 @@
+#include <avr/wdt.h>
+
+#include "journal.h"
+#include "display.h"    // Display::dhms(), Display::itoa()
+#include "lumi.h"       // lumi->dawn()
+
+Journal::Journal()
+  : qlen( 0 )
+  , lost( 0 )
+  , head( 0 )
+{
+}
+
+void Journal::setup( Ctrl * ctrlArg )
+{
+  ctrl = ctrlArg;
+
+  // head: end mark behind a record - while flush() writes, there are two:
+  // the old one and the new one up to QUEUE_LEN slots behind (maybe across slot 0)
+  byte mark[2];
+  byte marks = 0;
+  for (byte slot = 0; (slot < EE_SLOTS) && (marks < 2); ++slot)
+    if (ended( slot ) && ! ended( (slot + EE_SLOTS - 1) % EE_SLOTS ))
+      mark[marks++] = slot;
+
+  if (! marks) {  // no record in ring (never used)
+    head = 0;
+    Ctrl::save( EE_ADDR + 2, (uint8_t) EV_END );
+  } else if ((marks > 1) && (mark[1] - mark[0] > QUEUE_LEN))
+    head = mark[1];  // new mark wrapped to the start of the ring
+  else
+    head = mark[0];
+
+  put( EV_BOOT );
+}
+
+void Journal::put( byte type, byte val )
+{
+  if (qlen >= QUEUE_LEN) {
+    if (lost < 0xff)
+      ++lost;
+    return;
+  }
+
+  record & r = queue[qlen++];
+  unsigned long const secs = ctrl->sec - ctrl->lumi->dawn();
+  if ((long) secs < 0)
+    r.min = 0;  // during setup (ctrl->sec is -1)
+  else if (secs >= (0xffffUL * 60))
+    r.min = 0xffff;
+  else
+    r.min = secs / 60;
+  r.type = type;
+  r.val  = val;
+}
+
+void Journal::flush(void)
+{
+  if (lost) {
+    byte const n = lost;
+    --qlen;  // last queued record is replaced
+    put( EV_LOST, (n < 0xff) ? n + 1 : n );
+  }
+
+  // end mark first, then the records backwards, the type of each one last:
+  // the first slot (old end mark) is valid last - power gone while writing
+  // leaves the ring as before (setup() takes the old end mark as head,
+  // unless the ring was empty)
+  byte const end = (head + qlen) % EE_SLOTS;
+  Ctrl::save( EE_ADDR + end * sizeof(record) + 2, (uint8_t) EV_END );
+
+  for (byte i = qlen; i-- > 0; ) {
+    int const      addr = EE_ADDR + ((head + i) % EE_SLOTS) * sizeof(record);
+    record const & r    = queue[i];
+    Ctrl::save( addr,     (uint16_t) r.min );
+    Ctrl::save( addr + 3, (uint8_t)  r.val );
+    Ctrl::save( addr + 2, (uint8_t)  r.type );
+    wdt_reset();
+  }
+  head = end;
+
+  qlen = 0;
+  lost = 0;
+}
+
+boolean Journal::ended( byte slot )
+{
+  return (uint8_t) Ctrl::read1( EE_ADDR + slot * sizeof(record) + 2 ) == EV_END;
+}
+
+boolean Journal::get( byte idx, record & r )
+{
+  if (idx < qlen) {
+    r = queue[qlen - 1 - idx];
+    return true;
+  }
+  idx -= qlen;
+  if (idx >= (EE_SLOTS - 1))
+    return false;  // one slot is the end mark
+
+  byte const slot = (head + EE_SLOTS - 1 - idx) % EE_SLOTS;
+  Ctrl::readN( EE_ADDR + slot * sizeof(record), (uint8_t *) & r, sizeof(record) );
+  return r.type < EV_COUNT;  // end mark or not yet written
+}
+
+char * Journal::show( char * buf, byte menuitem )
+{
+  // |0123456789abcdef|
+  // |Pumpe    ein  12|  <- event, value, number (1: newest)
+  // |Morgen+  12:34 h|  <- time after dawn (or start up)
+
+  static char const names[] PROGMEM =  // 8 chars per EV
+    "Start   Morgen  Abend   Backup  Pumpe   Licht   P.Modus L.Modus verloren";
+  static char const modes[] PROGMEM =  // 4 chars per Switch::MODE
+    "aus ein autotemp";
+
+  record r;
+  if (! get( menuitem - 1, r ))
+    return 0;
+
+  memset( buf + 1, ' ', 33 );
+  buf[   0] = '|';
+  buf[0x11] = '|';
+  buf[0x22] = '|';
+  buf[0x23] = 0;
+
+  memcpy_P( buf + 1, names + 8 * r.type, 8 );
+  switch (r.type) {
+    case EV_PUMP:
+    case EV_LAMP:
+      memcpy_P( buf + 10, r.val ? PSTR( "ein" ) : PSTR( "aus" ), 3 );
+      break;
+    case EV_PUMP_MODE:
+    case EV_LAMP_MODE:
+      if (r.val < 4)
+        memcpy_P( buf + 10, modes + 4 * r.val, 4 );
+      break;
+    case EV_LOST:
+      Display::itoa( buf + 10, 4, r.val );
+      buf[13] = ' ';
+      break;
+  }
+  Display::itoa( buf + 0x0e, 4, menuitem );
+  buf[0x11] = '|';  // overwritten by itoa()
+
+  if ((r.type != EV_BOOT) && (r.type != EV_DAWN)) {
+    memcpy_P( buf + 0x12, (r.min == 0xffff) ? PSTR( "Morgen+ >" ) : PSTR( "Morgen+  " ), 9 );
+    Display::dhms( buf + 0x1b, r.min * 60UL );
+  }
+  return buf;
+}
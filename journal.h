@@ -0,0 +1,76 @@
+#ifndef Journal_h
+#define Journal_h
+
+#include <Arduino.h>
+#include "ctrl.h"
+
+// switching events in an EEPROM ring (survives reset and power loss)
+//
+// events are queued in RAM and written by flush(), which is called by
+// Ctrl::backup(): hourly, at dusk and dawn and on manual backup
+// (power loss: events of the last hour are lost)
+//
+// record (4 bytes):  u16 minutes after preceding EV_DAWN or EV_BOOT record (0xffff: later)
+//                    u8  type (EV), u8 value
+// the slot behind the newest record has type EV_END
+//
+//   EV_BOOT        0                  start up
+//   EV_DAWN        0                  dawn detected
+//   EV_DUSK        0                  dusk detected
+//   EV_BACKUP      0                  manual backup
+//   EV_PUMP        1: on / 0: off     pump relay switched
+//   EV_LAMP        1: on / 0: off     lamp relay switched
+//   EV_PUMP_MODE   Switch::MODE       pump switch mode changed
+//   EV_LAMP_MODE   Switch::MODE       lamp switch mode changed
+//   EV_LOST        count              events dropped (queue was full)
+
+class Journal
+{
+  public:
+    enum EV {
+      EV_BOOT = 0
+     ,EV_DAWN
+     ,EV_DUSK
+     ,EV_BACKUP
+     ,EV_PUMP
+     ,EV_LAMP
+     ,EV_PUMP_MODE
+     ,EV_LAMP_MODE
+     ,EV_LOST
+
+     ,EV_COUNT
+     ,EV_END = 0xff  // erased EEPROM
+    };
+    struct record {
+      word          min;    // minutes after preceding EV_DAWN / EV_BOOT
+      byte          type;   // EV
+      byte          val;
+    };
+
+  private:
+    enum {
+      EE_ADDR    = 0x2c0  // ring in EEPROM (behind backup records, before Ctrl::EE_ADDR_PFAIL)
+     ,EE_SLOTS   = 64     // records in ring
+     ,QUEUE_LEN  = 8      // max. records written per flush() (last one replaced by EV_LOST on overflow)
+    };
+
+    record        queue[QUEUE_LEN];  // not yet written
+    byte          qlen;
+    byte          lost;   // events dropped since last flush()
+    byte          head;   // slot of EV_END
+    Ctrl        * ctrl;
+
+    static boolean ended( byte slot );  // type of record in slot is EV_END
+
+  public:
+    Journal();
+    void    setup( Ctrl * ctrl );  // find end of ring and queue EV_BOOT
+    void    put( byte type, byte val = 0 );  // never writes EEPROM: dropped, when queue is full
+    void    flush(void);           // write queued records
+
+    boolean get( byte idx, record & r );  // idx 0: newest (incl. queued) / false: no such record
+
+    char  * show( char * buf, byte menuitem );
+};
+
+#endif
@@ -0,0 +1,160 @@
+
+#include "lcd.h"
+
+Lcd::Lcd( byte rsArg, byte enaArg, byte db4, byte db5, byte db6, byte db7 )
+  : rs(   rsArg )
+  , rw(  NO_PIN )
+  , ena( enaArg )
+  , head(     0 )
+  , tail(     0 )
+  , reading( false )
+  , usecReady(0 )
+{
+  db[0] = db4; db[1] = db5; db[2] = db6; db[3] = db7;
+}
+
+Lcd::Lcd( byte rsArg, byte rwArg, byte enaArg, byte db4, byte db5, byte db6, byte db7 )
+  : rs(   rsArg )
+  , rw(   rwArg )
+  , ena( enaArg )
+  , head(     0 )
+  , tail(     0 )
+  , reading( false )
+  , usecReady(0 )
+{
+  db[0] = db4; db[1] = db5; db[2] = db6; db[3] = db7;
+}
+
+void Lcd::begin(void)
+{
+  pinMode( rs,  OUTPUT );
+  pinMode( ena, OUTPUT );
+  if (rw != NO_PIN)
+    pinMode( rw, OUTPUT );
+  for (byte i = 0; i < 4; ++i)
+    pinMode( db[i], OUTPUT );
+
+  digitalWrite( rs,  LOW );
+  digitalWrite( ena, LOW );
+  if (rw != NO_PIN)
+    digitalWrite( rw, LOW );
+
+  // still 8 bit mode after power on: busy flag not yet readable
+  delay( 50 );               // more than 40 msec after power on
+  nibble( 3 );
+  delayMicroseconds( 4500 );
+  nibble( 3 );
+  delayMicroseconds( 4500 );
+  nibble( 3 );
+  delayMicroseconds( 150 );
+  nibble( 2 );               // -> 4 bit mode
+  delayMicroseconds( 100 );
+
+  put( 0x28, 1 );  // function set: 4 bit, 2 lines, 5x8 dots
+  put( 0x08, 1 );  // display off
+  put( 0x01, 1 );  // clear
+  put( 0x06, 1 );  // entry mode: increment, no shift
+  while (head != tail)
+    loop();
+}
+
+void Lcd::loop(void)
+{
+  if ((head == tail) || ! ready())
+    return;
+
+  byte const idx = head;
+  head = (head + 1) & (QUEUE_LEN - 1);
+  send( queue[idx], isCmd[idx >> 3] & (1 << (idx & 7)) );
+}
+
+void Lcd::clear(void)
+{
+  put( 0x01, 1 );
+}
+
+void Lcd::display(void)
+{
+  put( 0x0c, 1 );  // display on, cursor off, blink off
+}
+
+void Lcd::noDisplay(void)
+{
+  put( 0x08, 1 );
+}
+
+void Lcd::setCursor( byte col, byte row )
+{
+  put( 0x80 | (row ? 0x40 : 0) | col, 1 );
+}
+
+void Lcd::write( byte chr )
+{
+  put( chr, 0 );
+}
+
+void Lcd::put( byte val, byte cmd )
+{
+  byte const next = (tail + 1) & (QUEUE_LEN - 1);
+  while (next == head)  // queue full: no other way than to wait for the LCD
+    loop();
+
+  queue[tail] = val;
+  if (cmd)
+    isCmd[tail >> 3] |=  (1 << (tail & 7));
+  else
+    isCmd[tail >> 3] &= ~(1 << (tail & 7));
+  tail = next;
+}
+
+void Lcd::send( byte val, byte cmd )
+{
+  digitalWrite( rs, cmd ? LOW : HIGH );
+  nibble( val >> 4 );
+  nibble( val );
+
+  // used, when RW is not wired: clear and home take 1.52 msec, others 37 usec
+  usecReady = micros() + ((cmd && (val < 4)) ? 2000 : 50);
+}
+
+void Lcd::nibble( byte val )
+{
+  for (byte i = 0; i < 4; ++i)
+    digitalWrite( db[i], (val >> i) & 1 );
+
+  digitalWrite( ena, HIGH );
+  delayMicroseconds( 1 );    // enable pulse must be > 450 nsec
+  digitalWrite( ena, LOW );
+}
+
+boolean Lcd::ready(void)
+{
+  if (rw == NO_PIN)
+    return (long) (micros() - usecReady) >= 0;
+
+  if (! reading) {  // once per instruction: bus stays in read direction while busy
+    for (byte i = 0; i < 4; ++i)
+      pinMode( db[i], INPUT );
+    digitalWrite( rs,  LOW );
+    digitalWrite( rw,  HIGH );
+    reading = true;
+  }
+
+  digitalWrite( ena, HIGH );
+  delayMicroseconds( 1 );
+  byte const busy = digitalRead( db[3] );  // DB7 of high nibble: busy flag
+  digitalWrite( ena, LOW );
+  digitalWrite( ena, HIGH );               // low nibble (address counter) ignored
+  delayMicroseconds( 1 );
+  digitalWrite( ena, LOW );
+
+  // LCD not responding (busy flag floating): do not hang
+  if (busy && ((long) (micros() - usecReady) < 10000))
+    return false;  // check again on next call
+
+  digitalWrite( rw,  LOW );
+  for (byte i = 0; i < 4; ++i)
+    pinMode( db[i], OUTPUT );
+  reading = false;
+  return true;
+}
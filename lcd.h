@@ -0,0 +1,43 @@
+#ifndef Lcd_h
+#define Lcd_h
+
+#include <Arduino.h>
+
+class Lcd  // HD44780 in 4 bit mode: queued output, sent by loop() while LCD is not busy
+{
+  private:
+    enum {
+      QUEUE_LEN = 64  // power of 2
+     ,NO_PIN    = 0xff
+    };
+
+    byte      rs;      // register select
+    byte      rw;      // read/write (NO_PIN: not wired - use fixed delays)
+    byte      ena;     // enable
+    byte      db[4];   // DB4..DB7
+    byte      head;    // next queue entry to send
+    byte      tail;    // next free queue entry
+    byte      queue[QUEUE_LEN];     // instructions and data to send
+    byte      isCmd[QUEUE_LEN / 8]; // bit set: queue entry is instruction
+    boolean   reading;              // data pins are inputs: LCD was busy on last check (RW wired)
+    unsigned long usecReady;        // micros(), when LCD is ready again (when RW not wired)
+
+    void      put( byte val, byte cmd );   // append to queue
+    void      send( byte val, byte cmd );  // write to LCD (must be ready)
+    void      nibble( byte val );          // write low 4 bits of val
+    boolean   ready(void);                 // check busy flag once (or time, when RW not wired)
+
+  public:
+    Lcd( byte rs,          byte ena, byte db4, byte db5, byte db6, byte db7 );
+    Lcd( byte rs, byte rw, byte ena, byte db4, byte db5, byte db6, byte db7 );
+    void    begin(void);  // init 16x2 LCD (blocking: call in setup())
+    void    loop(void);   // send next queued byte, when LCD is ready
+
+    void    clear(void);
+    void    display(void);
+    void    noDisplay(void);
+    void    setCursor( byte col, byte row );
+    void    write( byte chr );
+};
+
+#endif
@@ -0,0 +1,38 @@
+#include "log.h"
+
+uint8_t Log::ring[RING_LEN];
+byte    Log::head = 0;
+byte    Log::tail = 0;
+byte    Log::lost = 0;
+
+void Log::put( byte id, void const * args, byte len )
+{
+  if ((byte) (head - tail - 1) % RING_LEN < len + 2) {  // free bytes
+    if (lost != 0xff)
+      ++lost;
+    return;
+  }
+
+  ring[tail] = len;  tail = (tail + 1) % RING_LEN;
+  ring[tail] = id;   tail = (tail + 1) % RING_LEN;
+  for (uint8_t const * cp = (uint8_t const *) args; len; --len) {
+    ring[tail] = *cp++;
+    tail = (tail + 1) % RING_LEN;
+  }
+}
+
+byte Log::get( uint8_t * buf )
+{
+  if (head == tail)
+    return 0;
+
+  byte const len = ring[head] + 2;  // + lost + id
+  head = (head + 1) % RING_LEN;
+  *buf++ = lost;
+  lost = 0;
+  for (byte n = 1; n < len; ++n) {
+    *buf++ = ring[head];
+    head = (head + 1) % RING_LEN;
+  }
+  return len;
+}
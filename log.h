@@ -0,0 +1,60 @@
+#ifndef Log_h
+#define Log_h
+
+#include <Arduino.h>
+
+// deferred debug messages: call sites store an id and binary arguments in a ring,
+// Telemetry::loop() sends them as REC_LOG frames, when the UART has time
+//
+// REC_LOG record:  type (REC_LOG), lost (u8: messages dropped before), id, args
+// args are packed little endian; the text is rendered by the receiver (tools/telemetry.py log):
+//
+//   MSG_BOOT         ""                                    "Piscino %s - (c) Holger Galuschka"  (VERSION)
+//   MSG_ALIVE        u32 sec                               " alive: %lu secs"
+//   MSG_LCD_INFO     char[32] row 1 + row 2                "    LCD info: |%.16s|%.16s|"
+//   MSG_LCD_MENU     char[32] row 1 + row 2                "    LCD menu: |%.16s|%.16s|"
+//   MSG_LCD_HINT     char[..15] (not terminated)           "     (here: \"%.*s\")"
+//   MSG_LCD_OOPS     char[7] overwritten guard bytes       "     oops: \"%.7s\""
+//   MSG_TEMP_ADDR    u8 sensor                             "  device %u: CRC of address is not valid!"
+//   MSG_TEMP_FAMILY  u8 sensor, u8 family code             "  device %u is not a DS18x20 family device (%02x)"
+//   MSG_TEMP_ERROR   u8 sensor, u8 error (Temp::ERROR)     "error on device %u: %s"
+//   MSG_TEMP_DATA    u8 sensor, u8[9] scratchpad           "  strange data for device %u: %02x ..."
+//   MSG_TEMP_RESULT  u8 result (Temp::RESULT), u32 before (ms), u32 time (ms),
+//                    i16 threshold, i16 diff (1/16 K)      "    %s (before/time/thres/diff)"
+
+class Log
+{
+  public:
+    enum MSG {
+      MSG_BOOT = 1
+     ,MSG_ALIVE
+     ,MSG_LCD_INFO
+     ,MSG_LCD_MENU
+     ,MSG_LCD_HINT
+     ,MSG_LCD_OOPS
+     ,MSG_TEMP_ADDR
+     ,MSG_TEMP_FAMILY
+     ,MSG_TEMP_ERROR
+     ,MSG_TEMP_DATA
+     ,MSG_TEMP_RESULT
+    };
+    enum {
+      MAX_ARGS = 32  // longest args of a message
+    };
+
+  private:
+    enum {
+      RING_LEN = 128  // power of 2
+    };
+
+    static uint8_t ring[RING_LEN];  // per message: length of args, id, args
+    static byte    head;            // oldest message
+    static byte    tail;            // next free byte
+    static byte    lost;            // messages dropped, since ring was full
+
+  public:
+    static void put( byte id, void const * args = 0, byte len = 0 );  // never waits: dropped, when ring is full
+    static byte get( uint8_t * buf );  // copy lost, id and args of oldest message / return: length (0: none)
+};
+
+#endif
@@ -1,7 +1,13 @@
 #include "ctrl.h"
 #include "lumi.h"
 #include "relay.h"
+#include "circuit.h"  // Circuit::SRC_LUMI, Circuit::REF_...
+#include "events.h"   // lamp and new day are posted
 #include "display.h"
+#include "adc.h"
+#include "sun.h"
+
+static_assert( (LATITUDE > -900) && (LATITUDE < 900), "LATITUDE: 1/10 deg between the poles" );
 
 //     12
 //     ___
@@ -13,9 +19,9 @@
 //
 //  status:
 //          0.. 6:  1  deep night:  check luminance >= lumDawn
-//          6..12:  2  early day:   check luminance >= lumDawn / 2 + 50% to clear 2
+//          6..12:  2  early day:   check luminance >= lumDay   to clear 2
 //         12..18:  0  light day:   check luminance <= lumDawn
-//         18..24:  3  early night: check luminance <= lumDawn / 2 to clear 2
+//         18..24:  3  early night: check luminance <= lumNight to clear 2
 //  status & 4 -> autoOn:
 //         18..24:  7  autoOn during detect deep night
 //          0.. 6:  5  autoOn during detect dawn
@@ -27,77 +33,134 @@
 Lumi::Lumi( byte pinArg )
   : pin(      pinArg )
   , status(        0 )  // see above
-  , cntDetect(     0 )  // how often did we detect sunrise/sunset in sequence
+  , detect(    false )  // not detecting sunrise/sunset
+  , offDone(   false )
+  , gen(           0 )  // backup values unchanged
   , lumSwitch( 0x200 )  // below this value: switch on light
-  , lumDawn(   0x200 )  // when 6 times in sequence above/below this value: sunrise/sunset
+  , lumDawn(   0x200 )  // when CONFIRM secs in sequence above/below this value: sunrise/sunset
   , lumNight(  0x100 )  // = (lumDawn / 2)    e.g. lumDawn = 40% -> lumNight = 20%
   , lumDay(    0x300 )  // = 50% + lumNight   e.g. lumDawn = 40% -> lumDay   = 70%
   , lumCurr(   0x200 )  // current luminance value
+  , autoDawn(  0x200 )  // until calibrated by histogram
+  , autoNight(     0 )  // not yet calibrated
+  , autoDay(       0 )
+  , sclSwitch( SCALE_ONE )
+  , sclDawn(   SCALE_ONE )
+  , day(           0 )  // unknown
+  , dayNum(        0 )  // dawns counted
+  , obsHead(       0 )  // ring of observations empty
   , secCorr(       0 )  // correction to calculate midnight (DST / local geo offset)
   , timeOff(   -3600 )  // 1h before midnight
   , secOff(        0 )  // ctrl->sec, when to switch off today (calculated, when switched on)
+  , secNext(       0 )  // evaluate at once
+  , secDetect(     0 )
   , dayLight(  43200L)  // as long as we don't know better, we assume 12 hours day light
+  , dayPred(       0 )  // no model
   , midnight(      0 )  // yet unknown
   , secDusk(       0 )  // sunset time (secs counter)
   , secDawn(       0 )  // sunrise time (secs counter)
 {
+  memset( obs,  0, sizeof(obs) );   // no observations
+  memset( hist, 0, sizeof(hist) );  // nothing counted
 }
 
-void Lumi::setup( Ctrl * ctrlArg )
+void Lumi::setup( Ctrl * ctrlArg, Adc * adcArg )
 {
   ctrl = ctrlArg;
+  adc  = adcArg;
+  chan = adc->add( pin, Adc::FILTERED );
 }
 
 byte Lumi::secLoop(void)
 {
-  if (ctrl->sec % 10)
-    return NOCHANGE;
-
-  lumCurr = analogRead( pin );  // current luminance
-  ctrl->display->info( Display::NUM_LUM, (((lumCurr * 25) + 0x80) >> 8) & 0x7f );
+  Ctrl::crumb = Ctrl::CRUMB_LUMI;
 
   if (status & 4) {
     // secOff is the absolute time value, when we have to switch off
     signed long diff = secOff - ctrl->sec;
     if (diff <= 0) {
       status &= 3;
-      ctrl->lampRelay->autoOn( 0 );
+      offDone = true;
+      ctrl->events->post( Events::EV_AUTO, Circuit::SRC_LUMI, 0 );
     }
   }
 
+  if (! (ctrl->sec % 60)) {  // histogram counts minutes
+    byte const b = bin( (adc->value( chan ) + 8) >> 4 );
+    if (hist[b] < 0xffff)
+      ++hist[b];
+  }
+
+  if ((long) (ctrl->sec - secNext) < 0)
+    return NOCHANGE;
+
+  lumCurr = (adc->value( chan ) + 8) >> 4;  // current luminance (filtered by interrupt)
+  ctrl->events->post( Events::EV_INFO, Display::NUM_LUM, (((lumCurr * 25) + 0x80) >> 8) & 0x7f );
+  secNext = ctrl->sec + step();
+
   switch (status & 3)  // 1-2-0-3 (night-morning-day-evening)
   {
     case 1:  //  0.. 6 (deep night): check luminance >= lumDawn
-      if (lumCurr < lumDawn) {
-        cntDetect = 0;
+      if (! confirm( lumCurr >= lumDawn ))
         break;
-      }
-      if (++cntDetect < 6)
+      if (early( midnight - secCorr + 43200L - (dayPred / 2L) )) {  // e.g. lamp shining on sensor
+        detect = false;
         break;
+      }
+
+      nextDay();
+      for (byte i = 0; i < HIST_BINS; ++i)
+        hist[i] -= hist[i] >> 2;  // age histogram: 3/4 per day
+      calibrate();
 
-      if (secDusk)  // when not set, we booted up at night
-        dayLight = (secDusk + 86400L - ctrl->sec);
+      if (secDusk && ((ctrl->sec - secDusk) < 86400L)) {  // when not set, we booted up at night
+        unsigned long const mid = secDusk + ((ctrl->sec - secDusk) / 2L);  // solar midnight
+        if (! midnight) {  // booted up at day: clock starts with this night
+          long e;
+          midnight = mid + secCorr - (fit( false, 0, e ) ? e : 0);
+        }
+        observe( mid, plausible( secDusk + 86400L - ctrl->sec ) );
         // secDusk is dusk of yesterday
         // ==> secDusk of today will be 86400 secs later
+      }
+
+      long val;
+      if (fit( true, 0, val ))
+        dayLight = val * 2L;  // trend of last nights: one stormy evening does not count
+      else if (dayPred)
+        dayLight = dayPred;
       // else: daylight read from backup
 
       secDawn = ctrl->sec;  // remember dawn time
-      midnight = secDawn + (dayLight / 2L) + secCorr + 43200L;  // next midnight
+      ++gen;                // dayLight, observations and histogram changed
+      if (midnight) {
+        while ((long) (midnight - secDawn) <= 0)
+          midnight += 86400L;  // next midnight of clock
+        if (fit( false, 1, val )) {
+          midnight += val;  // clock follows trend of solar midnight
+          shift( val );
+        }
+      } else {
+        midnight = secDawn + (dayLight / 2L) + secCorr + 43200L;  // next midnight by dawn only
+        if (fit( false, 1, val ))
+          shift( val );  // clock starts here: ring (of before reset) relative to it
+      }
 
-      cntDetect = 0;
+      detect  = false;
+      offDone = false;
       if (status & 4)
-        ctrl->lampRelay->autoOn( 0 );  // auto off in any case at dawn
+        ctrl->events->post( Events::EV_AUTO, Circuit::SRC_LUMI, 0 );  // auto off in any case at dawn
 
       status = 2;
-      ctrl->pumpRelay->night( 0 );  // start new day when dawn (to even check values at night)
+      ctrl->events->post( Events::EV_NEW_DAY, Circuit::REF_DAWN );  // e.g. pump: new day when dawn (to even check values at night)
 
       return DAWN;
 
     case 2:  //  6..12:  check luminance >= 50% + lumDawn / 2 to clear 2
-      if (lumCurr < lumDay)
-        cntDetect = 0;
-      else if (++cntDetect >= 6)
+      if (confirm( lumCurr >= lumDay )) {
         status &= 5;
+        detect = false;
+      }
       break;
 
     case 0:  // 12..18:  check luminance < lumDawn
@@ -105,63 +168,406 @@ byte Lumi::secLoop(void)
       if (status & 4) {             // switched on
         if (lumCurr > lumSwitch + 50) {  // again 5% lighter than needed (temporary dark)
           status = 0;
-          ctrl->lampRelay->autoOn( 0 );
+          ctrl->events->post( Events::EV_AUTO, Circuit::SRC_LUMI, 0 );
         }
       } else {                      // not yet switched on
         if (lumCurr < lumSwitch) {  // already dark enough to switch on
-          status |= 4;
-          ctrl->lampRelay->autoOn( 1 );
           if (midnight)
-            secOff = midnight;  // midnight is next(!) midnight
+            switchOn( midnight );  // midnight is next(!) midnight
           else
-            secOff = ctrl->sec + (86400 - dayLight) / 2;  // half night
-          secOff += timeOff;
+            switchOn( ctrl->sec + (86400 - dayLight) / 2 );  // half night
         }
       }
 
       if (lumCurr >= lumDawn) {   // not yet sunset
-        cntDetect = 0;
+        detect = false;
         break;
       }
-      if ((++cntDetect < 6) && ctrl->sec)  // detect night during boot up
+      if (! confirm( true ) && ctrl->sec)  // detect night during boot up
+        break;
+      if (ctrl->sec && early( midnight - secCorr - 43200L + (dayPred / 2L) )) {  // e.g. thunderstorm
+        detect = false;
         break;
+      }
 
       if (secDawn && ! midnight) {  // boot up last night: we calc midnight here
         // secDawn is dawn of this morning
         // ==> secDusk of today will be 86400 secs later
-        dayLight = (ctrl->sec - secDawn);
+        dayLight = plausible( ctrl->sec - secDawn );
+        ++gen;
         midnight = secDawn + (dayLight / 2L) + secCorr + 43200L;  // next midnight
         if (status & 4)
           secOff = midnight + timeOff;  // midnight is next(!) midnight
+      } else if (ctrl->sec && ! midnight) {  // boot up at day: ring or model seeds midnight
+        long    val;
+        boolean seed = true;
+        if (fit( true, 1, val ))
+          dayLight = val * 2L;
+        else if (dayPred)
+          dayLight = dayPred;
+        else
+          seed = false;  // wait for dawn
+
+        if (seed) {
+          ++gen;
+          midnight = ctrl->sec - (dayLight / 2L) + secCorr + 43200L;  // next midnight
+          if (fit( false, 1, val ))
+            shift( val );  // clock starts here: ring (of before reset) relative to it
+          if (status & 4)
+            secOff = midnight + timeOff;
+        }
       }
       secDusk = ctrl->sec;  // remember dusk time (maybe 0, when boot up at night)
-      cntDetect = 0;
+      detect  = false;
       status |= 3;
-      ctrl->lampRelay->night( 1 );  // start new day when dusk (to check values next day)
+      ctrl->events->post( Events::EV_NEW_DAY, Circuit::REF_DUSK );  // e.g. lamp: new day when dusk (to check values next day)
 
       return DUSK;
 
     case 3:  // 18..24:  night and check luminance <= lumDawn / 2 to clear 2
-      if (lumCurr > lumNight)
-        cntDetect = 0;
-      else if (++cntDetect >= 6)
+      if (confirm( lumCurr <= lumNight )) {
         status &= 5;
+        detect = false;
+      }
       break;
   }
 
   if (((status & 5) == 1) && (lumCurr < lumSwitch)) {  // now dark enough to switch on
-    status |= 4;
-    ctrl->lampRelay->autoOn( 1 );
     if (midnight)
-      secOff = midnight;  // midnight is still next(!) midnight
+      switchOn( midnight );  // midnight is still next(!) midnight
     else
-      secOff = secDusk + (86400 - dayLight) / 2;  // even when secDusk is 0
-    secOff += timeOff;
+      switchOn( secDusk + (86400 - dayLight) / 2 );  // even when secDusk is 0
   }
 
   return NOCHANGE;
 }
 
+void Lumi::switchOn( unsigned long off )
+{
+  off += timeOff;
+  if (offDone || ((long) (off - ctrl->sec) <= 0))
+    return;  // switched off already this night
+
+  status |= 4;
+  ctrl->events->post( Events::EV_AUTO, Circuit::SRC_LUMI, 1 );
+  secOff = off;
+}
+
+static word distance( word lum, word thr )
+{
+  return (lum > thr) ? lum - thr : thr - lum;
+}
+
+byte Lumi::step(void)
+{
+  word dist = distance( lumCurr, lumDawn );  // to nearest threshold of current state
+  word d    = distance( lumCurr, lumSwitch );
+  if (d < dist)
+    dist = d;
+  if ((status & 3) == 2)
+    d = distance( lumCurr, lumDay );
+  else if ((status & 3) == 3)
+    d = distance( lumCurr, lumNight );
+  if (d < dist)
+    dist = d;
+
+  word secs = dist / STEP_LUM;
+  if (secs > (detect ? STEP_DET : STEP_MAX))
+    secs = detect ? STEP_DET : STEP_MAX;
+  return secs ? secs : 1;  // at threshold: every sec
+}
+
+boolean Lumi::confirm( boolean hit )
+{
+  if (! hit) {
+    detect = false;
+    return false;
+  }
+  if (! detect) {  // first hit: evaluate often enough to see misses
+    detect    = true;
+    secDetect = ctrl->sec;
+    if ((long) (secNext - ctrl->sec) > STEP_DET)
+      secNext = ctrl->sec + STEP_DET;
+  }
+  return (ctrl->sec - secDetect) >= CONFIRM;
+}
+
+static word const binLum[] PROGMEM =  // luminance at center of histogram bin (geometric)
+  { 2, 5, 10, 14, 20, 28, 39, 55, 78, 111, 157, 222, 314, 443, 627, 887 };
+
+byte Lumi::bin( word lum )
+{
+  if (lum < 8)
+    return lum >> 2;
+
+  byte b = 2;
+  while (lum >= 16) {  // per octave
+    lum >>= 1;
+    b   += 2;
+  }
+  b += (lum >> 2) & 1;  // 8..11: lower / 12..15: upper half of octave
+  return (b < HIST_BINS) ? b : HIST_BINS - 1;
+}
+
+word Lumi::scale( word lum, word scl )
+{
+  unsigned long const v = ((unsigned long) lum * scl + (SCALE_ONE / 2)) / SCALE_ONE;
+  return (v < LUM_MAX) ? v : (unsigned long) LUM_MAX;
+}
+
+static word isqrt( unsigned long n )  // n < 0x100000
+{
+  word r = 0;
+  for (word bit = 0x200; bit; bit >>= 1)
+    if ((unsigned long) (r | bit) * (r | bit) <= n)
+      r |= bit;
+  return r;
+}
+
+word Lumi::plateau( byte p )
+{
+  // centroid of peak and neighbours (1/16 bins), interpolated between centers of bins
+  unsigned long sum  = 0;
+  unsigned long wsum = 0;
+  for (byte i = p ? p - 1 : 0; (i <= p + 1) && (i < HIST_BINS); ++i) {
+    sum  += hist[i];
+    wsum += (unsigned long) hist[i] * i * 16;
+  }
+  word const pos = wsum / sum;
+  byte const b   = pos >> 4;
+  word       lum = pgm_read_word( & binLum[b] );
+  if (b < (HIST_BINS - 1))
+    lum += ((pgm_read_word( & binLum[b + 1] ) - lum) * (pos & 15)) >> 4;
+  return lum;
+}
+
+void Lumi::calibrate(void)
+{
+  // night and day plateau: highest bin and highest bin at least HIST_GAP apart
+  unsigned long sum = 0;
+  byte p1 = 0;
+  for (byte i = 0; i < HIST_BINS; ++i) {
+    sum += hist[i];
+    if (hist[i] > hist[p1])
+      p1 = i;
+  }
+  byte p2 = 0xff;
+  for (byte i = 0; i < HIST_BINS; ++i)
+    if (((i + HIST_GAP <= p1) || (i >= p1 + HIST_GAP)) && ((p2 == 0xff) || (hist[i] > hist[p2])))
+      p2 = i;
+
+  if ((sum >= HIST_MIN) && (p2 != 0xff) && (hist[p2] >= (hist[p1] >> 4))) {
+    word const night = plateau( (p1 < p2) ? p1 : p2 );
+    word const day   = plateau( (p1 < p2) ? p2 : p1 );
+    autoDawn  = isqrt( (unsigned long) night * day );  // middle on log scale
+    if (autoDawn < 8)
+      autoDawn = 8;  // resolution of manual setting
+    autoNight = isqrt( (unsigned long) night * autoDawn );
+    autoDay   = isqrt( (unsigned long) autoDawn * day );
+  }
+  apply();
+}
+
+void Lumi::apply(void)
+{
+  lumSwitch = scale( autoDawn, sclSwitch );
+  lumDawn   = scale( autoDawn, sclDawn );
+  if (autoNight) {
+    lumNight = scale( autoNight, sclDawn );
+    lumDay   = scale( autoDay,   sclDawn );
+  } else {
+    lumNight = (lumDawn / 2);     // e.g. lumDawn = 40% -> lumNight = 20%
+    lumDay   = 0x200 + lumNight;  // e.g. lumDawn = 40% -> lumDay   = 70%
+  }
+}
+
+void Lumi::predict(void)
+{
+  dayPred = (LATITUDE && day) ? Sun::dayLight( LATITUDE, day ) : 0;
+}
+
+void Lumi::nextDay(void)
+{
+  word days = 1;  // booted up at night: assume last dawn was yesterday
+  if (secDawn) {
+    days = (ctrl->sec - secDawn + 43200L) / 86400L;
+    if (! days)
+      days = 1;
+  }
+  dayNum += days;
+
+  if (! day)
+    return;  // unknown
+  day = ((day - 1 + days) % Sun::DAYS) + 1;
+  predict();
+}
+
+static int16_t clip( long secs )
+{
+  if (secs > 32767L)
+    return 32767;
+  if (secs < -32767L)
+    return -32767;
+  return secs;
+}
+
+void Lumi::observe( unsigned long mid, unsigned long light )
+{
+  long e = (long) (mid + secCorr - midnight) % 86400L;  // clock's error of this night
+  if (e > 43200L)
+    e -= 86400L;
+  else if (e < -43200L)
+    e += 86400L;
+
+  observation & o = obs[obsHead];
+  o.mid   = clip( e );
+  o.light = (light + 1) / 2;
+  o.num   = dayNum;
+  if (++obsHead >= OBS_LEN)
+    obsHead = 0;
+}
+
+boolean Lumi::fit( boolean light, signed char at, long & val )
+{
+  // least squares line through the ring (x: day, y: 16 * value);
+  // the worst observation is dropped and the line fitted again,
+  // as long as it is off more than REJECT and more than 2 are left
+  byte use = 0;  // bit per observation
+  for (byte i = 0; i < OBS_LEN; ++i)
+    if (obs[i].light && ((byte) (dayNum - obs[i].num) < OBS_DAYS))
+      use |= 1 << i;
+
+  for (;;) {
+    byte n  = 0;
+    long sx = 0, sxx = 0, sy = 0, sxy = 0;
+    for (byte i = 0; i < OBS_LEN; ++i) {
+      if (! (use & (1 << i)))
+        continue;
+      long const x = - (long) (byte) (dayNum - obs[i].num);
+      long const y = light ? obs[i].light : obs[i].mid;
+      ++n;
+      sx  += x;
+      sxx += x * x;
+      sy  += y;
+      sxy += x * y;
+    }
+    if (! n)
+      return false;
+
+    long b = 0;  // slope: 1/16 per day (at least 3 observations)
+    long const den = n * sxx - sx * sx;
+    if ((n >= 3) && den)
+      b = ((n * sxy - sx * sy) << 4) / den;
+    long const a = ((sy << 4) - b * sx) / n;  // 1/16 at day 0
+
+    byte worst = 0xff;
+    long dMax  = REJECT << 4;
+    for (byte i = 0; (n > 2) && (i < OBS_LEN); ++i) {
+      if (! (use & (1 << i)))
+        continue;
+      long const x = - (long) (byte) (dayNum - obs[i].num);
+      long d = ((long) (light ? obs[i].light : obs[i].mid) << 4) - (a + b * x);
+      if (d < 0)
+        d = -d;
+      if (d > dMax) {
+        dMax  = d;
+        worst = i;
+      }
+    }
+    if (worst == 0xff) {
+      val = (a + b * at + 8) >> 4;
+      return true;
+    }
+    use &= ~(1 << worst);
+  }
+}
+
+void Lumi::shift( long secs )
+{
+  for (byte i = 0; i < OBS_LEN; ++i)
+    if (obs[i].light)
+      obs[i].mid = clip( obs[i].mid - secs );
+}
+
+boolean Lumi::early( unsigned long expected )
+{
+  // late detections are accepted: the model must not block detection,
+  // when midnight is outdated (no detection for days)
+  return dayPred && midnight && ((long) (expected - ctrl->sec) > TOLERANCE);
+}
+
+unsigned long Lumi::plausible( unsigned long measured )
+{
+  long const diff = measured - dayPred;
+  if (dayPred && ((diff > TOLERANCE) || (diff < -TOLERANCE)))
+    return dayPred;  // e.g. cloudy evening
+  return measured;
+}
+
+long Lumi::clock(void)
+{
+  if (! midnight)
+    return -1;
+  long t = (long) (ctrl->sec - midnight) % 86400L;
+  return (t < 0) ? t + 86400L : t;
+}
+
+long Lumi::get( byte par )
+{
+  switch (par) {
+    case PAR_LUMSWITCH: return lumSwitch;
+    case PAR_LUMDAWN:   return lumDawn;
+    case PAR_TIMEOFF:   return timeOff;
+    case PAR_DAY:       return day;
+    case PAR_CLOCK:     return clock();
+    default:            return secCorr;
+  }
+}
+
+boolean Lumi::set( byte par, long val )
+{
+  switch (par) {
+    case PAR_LUMSWITCH:
+    case PAR_LUMDAWN:
+      if ((val < 0) || (val > LUM_MAX))
+        return false;
+      if (par == PAR_LUMSWITCH)
+        sclSwitch = (val * SCALE_ONE + (autoDawn / 2)) / autoDawn;
+      else
+        sclDawn   = (val * SCALE_ONE + (autoDawn / 2)) / autoDawn;
+      apply();
+      break;
+
+    case PAR_TIMEOFF:
+      if ((val > TIMEOFF_MAX) || (val < -TIMEOFF_MAX))
+        return false;
+      timeOff = val;
+      break;
+
+    case PAR_DAY:
+      if ((val < 0) || (val > Sun::DAYS))
+        return false;
+      day = val;
+      predict();
+      break;
+
+    case PAR_CLOCK:
+      if (! midnight)
+        return false;
+      return set( PAR_SECCORR, secCorr - (val - clock()) );  // later midnight: earlier clock
+
+    default:
+      if ((val > SECCORR_MAX) || (val < -SECCORR_MAX))
+        return false;
+      if (midnight)
+        midnight += val - secCorr;
+      secCorr = val;
+      break;
+  }
+  ++gen;
+  return true;
+}
+
 int Lumi::backup( int addr )
 {
   addr = Ctrl::save( addr, (uint32_t) timeOff   );
@@ -169,6 +575,13 @@ int Lumi::backup( int addr )
   addr = Ctrl::save( addr, (uint16_t) secCorr   );
   addr = Ctrl::save( addr, (uint16_t) lumSwitch );
   addr = Ctrl::save( addr, (uint16_t) lumDawn   );
+  addr = Ctrl::save( addr, (uint16_t) day       );
+  addr = Ctrl::save( addr, (uint8_t)  dayNum    );
+  addr = Ctrl::save( addr, (uint8_t)  obsHead   );
+  addr = Ctrl::save( addr, (uint8_t const *) obs, sizeof(obs) );
+  addr = Ctrl::save( addr, (uint16_t) sclSwitch );
+  addr = Ctrl::save( addr, (uint16_t) sclDawn   );
+  addr = Ctrl::save( addr, (uint8_t const *) hist, sizeof(hist) );
   return addr;
 }
 
@@ -178,21 +591,38 @@ void Lumi::restore( int addr, uint8_t len )
     timeOff   = Ctrl::read4( addr +  0 );
     dayLight  = Ctrl::read4( addr +  4 );
     secCorr   = Ctrl::read2( addr +  8 );
-    lumSwitch = Ctrl::read2( addr + 10 );
-    lumDawn   = Ctrl::read2( addr + 12 );
-
-    lumNight  = (lumDawn / 2);     // e.g. lumDawn = 40% -> lumNight = 20%
-    lumDay    = 0x200 + lumNight;  // e.g. lumDawn = 40% -> lumDay   = 70%
+    sclSwitch = ((unsigned long) Ctrl::read2( addr + 10 ) * SCALE_ONE) / autoDawn;  // lumSwitch
+    sclDawn   = ((unsigned long) Ctrl::read2( addr + 12 ) * SCALE_ONE) / autoDawn;  // lumDawn
+    apply();
     if ((dayLight <= 7200L) || (dayLight >= 79200L))
       dayLight = 43200L;  // 43200=12h 57600=16h
   }
+  if (len >= 16) {
+    day = Ctrl::read2( addr + 14 );
+    if (day > Sun::DAYS)
+      day = 0;
+    predict();
+  }
+  if (len >= 18 + sizeof(obs)) {
+    dayNum  = Ctrl::read1( addr + 16 );
+    obsHead = Ctrl::read1( addr + 17 );
+    Ctrl::readN( addr + 18, (uint8_t *) obs, sizeof(obs) );
+    if (obsHead >= OBS_LEN) {  // invalid
+      obsHead = 0;
+      memset( obs, 0, sizeof(obs) );
+    }
+  }
+  if (len >= 22 + sizeof(obs) + sizeof(hist)) {
+    sclSwitch = Ctrl::read2( addr + 18 + sizeof(obs) );
+    sclDawn   = Ctrl::read2( addr + 20 + sizeof(obs) );
+    Ctrl::readN( addr + 22 + sizeof(obs), (uint8_t *) hist, sizeof(hist) );
+    calibrate();
+  }
 }
 
-static short adjtbl[] = { 3600, 600, 60, 10, 1 };  // 1 hour, 10 min, 1 min, 10 sec, 1 sec
-
-char * Lumi::showTime( char * buf, byte menuitem, byte init )
+char * Lumi::showTime( char * buf, byte menuitem )
 {
-  if ((menuitem > 11) || ((! midnight) && (menuitem > 1)))
+  if (menuitem > 1)
     return 0;
 
   memset( buf, ' ', 0x22 );
@@ -201,63 +631,23 @@ char * Lumi::showTime( char * buf, byte menuitem, byte init )
   buf[0x22] = '|';
   buf[0x23] = 0;
 
-  if (menuitem == 1) {
-    memcpy(         buf +    1, "Korr.: ", 7 );
-    if (secCorr < 0) {
-      buf[8] = '-';
-      Display::hms( buf +    9, -secCorr );
-    } else {
-      buf[8] = '+';
-      Display::hms( buf +    9, secCorr );
-    }
-    buf[0x11] = '|';
-    if (midnight) {
-      memcpy(       buf + 0x12, "Uhrzeit:", 8 );
-      Display::hms( buf + 0x1a, ctrl->sec - midnight );  // modulo done in hms()
-    }
-    return buf;
-  }
-
-  // menuitem  adj
-  //      2: +3600
-  //      3: -3600
-  //      4:  +600
-  //      5:  -600
-  //      6:   +60
-  //      7:   -60
-  //      8:   +10
-  //      9:   -10
-  //     10:    +1
-  //     11:    -1
-
-  short adj = adjtbl[ (menuitem - 2) >> 1 ];
-
-  memcpy(       buf +    1, "Zeit  +=", 8 );
-  Display::hms( buf +    9, adj );
-  if (menuitem & 1)
-    buf[7] = '-';
-  else
-    adj = -adj;  // decrement secCorr and midnight to increase time
-
-  if (init)
-    secEnter = ctrl->sec;
-  else if (ctrl->sec > (secEnter + 3)) {
-    secCorr += adj;
-    if ((secCorr > +14400) || (secCorr < -14400)) {  // +/-4h
-      secCorr -= adj;  // undo when out of range
-      memcpy( buf +    1, "Limit erreicht  ", 16 );
-    } else {
-      midnight += adj;
-    }
+  memcpy_P(       buf +    1, PSTR( "Korr.: " ), 7 );
+  if (secCorr < 0) {
+    buf[8] = '-';
+    Display::hms( buf +    9, -secCorr );
+  } else {
+    buf[8] = '+';
+    Display::hms( buf +    9, secCorr );
   }
-  memcpy(       buf + 0x12, "Uhrzeit:", 8 );
-  Display::hms( buf + 0x1a, ctrl->sec - midnight );
   buf[0x11] = '|';
-  buf[0x22] = '|';
+  if (midnight) {
+    memcpy_P(     buf + 0x12, PSTR( "Uhrzeit:" ), 8 );
+    Display::hms( buf + 0x1a, ctrl->sec - midnight );  // modulo done in hms()
+  }
   return buf;
 }
 
-char * Lumi::showDown( char * buf, byte menuitem, byte init )
+char * Lumi::showDown( char * buf, byte menuitem )
 {
   // |0123456789abcdef|
   // |Tag seit: 3:45 h|
@@ -265,153 +655,93 @@ char * Lumi::showDown( char * buf, byte menuitem, byte init )
 
   memset( buf, ' ', 0x22 );
 
-  if ((! midnight) && (menuitem >= 2))
-    ++menuitem;  // 2..14 -> 3..15 (skip item 2 since no info)
-
-  short adj;
-
   switch (menuitem) {
     case 1:
       if (status & 1) {
         if (secDusk) {
-          memcpy(        buf +    1, "N. seit: ", 9 );
+          memcpy_P(      buf +    1, PSTR( "N. seit: " ), 9 );
           Display::dhms( buf +   10, ctrl->sec - secDusk );
         } else {
-          memcpy(        buf +    1, "Nacht",     5 );
+          memcpy_P(      buf +    1, PSTR( "Nacht" ),     5 );
         }
       } else {
         if (secDawn) {
-          memcpy(        buf +    1, "Tag seit:", 9 );
+          memcpy_P(      buf +    1, PSTR( "Tag seit:" ), 9 );
           Display::dhms( buf +   10, ctrl->sec - secDawn );
         } else {
-          memcpy(        buf +    1, "Tag",       3 );
+          memcpy_P(      buf +    1, PSTR( "Tag" ),       3 );
         }
       }
-      memcpy(        buf + 0x12, "hell:    ", 9 );
+      memcpy_P(      buf + 0x12, PSTR( "hell:    " ), 9 );
       Display::dhms( buf + 0x1b, dayLight );
       break;
 
     case 2:
+      if (! midnight)
+        return 0;  // skipped: no info
       if (secDawn) {
-        memcpy(       buf +    1, "Aufgang:", 8 );
+        memcpy_P(     buf +    1, PSTR( "Aufgang:" ), 8 );
         Display::hms( buf +    9, secDawn - midnight );  // modulo done in hms()
       }
       if (secDusk) {
-        memcpy(       buf + 0x12, "Unterg.:", 8 );
+        memcpy_P(     buf + 0x12, PSTR( "Unterg.:" ), 8 );
         Display::hms( buf + 0x1a, secDusk - midnight );  // modulo done in hms()
       }
       break;
 
     case 3:
-      memcpy(       buf +    1, "Absch.: ", 8 );
+      memcpy_P(     buf +    1, PSTR( "Absch.: " ), 8 );
       Display::hms( buf +    9, timeOff );
 
       if (midnight) {
         if (secOff) {
           if (secOff < ctrl->sec) {             // turned off in past
-            memcpy(       buf + 0x12, "abges.: ", 8 );
+            memcpy_P(     buf + 0x12, PSTR( "abges.: " ), 8 );
             Display::hms( buf + 0x1a, secOff - midnight );
           } else                                // will turn off in future
           if (secOff < (ctrl->sec + 43200L)) {  // less than 12h
-            memcpy(       buf + 0x12, "absch.: ", 8 );
+            memcpy_P(     buf + 0x12, PSTR( "absch.: " ), 8 );
             Display::hms( buf + 0x1a, secOff - midnight );
           } else {                              // error: more than 12h
-            memcpy(        buf + 0x12, "noch ein:", 9 );
+            memcpy_P(      buf + 0x12, PSTR( "noch ein:" ), 9 );
             Display::dhms( buf + 0x1b, secOff - ctrl->sec );
           }
         }
       } else if (status & 4) {
         long const diff = secOff - ctrl->sec;
         if (diff > 0) {
-          memcpy(        buf + 0x12, "noch ein:", 9 );
+          memcpy_P(      buf + 0x12, PSTR( "noch ein:" ), 9 );
           Display::dhms( buf + 0x1b, diff );
         } else if (diff >= -10) {
-          memcpy(        buf + 0x12, "aus", 3 );
+          memcpy_P(      buf + 0x12, PSTR( "aus" ), 3 );
           memset(        buf + 0x15, '.', -diff );
         } else {
-          memcpy(        buf + 0x12, "sollte aus sein! ", 16 );
+          memcpy_P(      buf + 0x12, PSTR( "sollte aus sein! " ), 16 );
         }
       } else if (secOff) {
-        memcpy(        buf + 0x12, "aus seit:", 9 );
+        memcpy_P(      buf + 0x12, PSTR( "aus seit:" ), 9 );
         Display::dhms( buf + 0x1b, ctrl->sec - secOff );
       }
       break;
 
-    default:
-      if (menuitem >= 14)
-        return 0;
-
-      if (menuitem >= 10) {
-        // menuitem  adj
-        //   10: lumSwitch += 10%
-        //   11: lumSwitch -= 10%
-        //   12: lumDawn   += 10%
-        //   13: lumDawn   -= 10%
-                                // 0123456789abcdef
-        memcpy(       buf +    1, "Schwellwert erh.", 16 );
-        if (menuitem & 1)
-          memcpy(     buf +  0xd, "red.", 4 );
-
-        word * pval;
-        if (menuitem & 2) {
-          memcpy(     buf + 0x12, "D" STR_AUML "mmerung:     %", 16 );
-          pval = & lumDawn;
-        } else {
-          memcpy(     buf + 0x12, "Schaltpunkt:   %", 16 );
-          pval = & lumSwitch;
-        }
-        if (init)
-          secEnter = ctrl->sec;
-        else if (ctrl->sec > (secEnter + 3)) {
-          if (menuitem & 1) {
-            if ((*pval >= 204) && (*pval <= 922))   // 20..90%: -=10%
-              *pval = (((((((*pval * 10) + 0x200) >> 10) & 0xf) - 1) << 10) + 5) / 10;
-            else if (*pval >= 20)                   // 2..100%: -=1%
-              *pval = (((((((*pval * 25) +  0x80) >> 8) & 0x7f) - 1) << 8) + 12) / 25;
-          } else {
-            if ((*pval >= 102) && (*pval <= 820))   // 10..80%: +=10%
-              *pval = (((((((*pval * 10) + 0x200) >> 10) & 0xf) + 1) << 10) + 5) / 10;
-            else if (*pval <= 1004)                 //  0..98%: +=1%
-              *pval = (((((((*pval * 25) +  0x80) >> 8) & 0x7f) + 1) << 8) + 12) / 25;
-          }
-          if (menuitem & 2) {
-            lumNight = (lumDawn / 2);
-            lumDay   = 0x200 + lumNight;
-          }
-        }
-        Display::itoa( buf + 0x1f, 3, (((*pval * 25) + 0x80) >> 8) & 0x7f );
-        buf[0x21] = '%';
+    case 4:
+      // |Auto-Nacht:  5 %|  <- thresholds calibrated by histogram
+      // |Auto-Tag:   87 %|     (without manual setting)
+      if (! autoNight) {
+        memcpy_P(   buf +    1, PSTR( "Histogramm:" ), 11 );
+        memcpy_P(   buf + 0x12, PSTR( "zu wenig Daten" ), 14 );
         break;
       }
-
-      // menuitem   adj
-      //       4: +3600
-      //       5: -3600
-      //       6:  +600
-      //       7:  -600
-      //       8:   +60
-      //       9:   -60
-      adj = adjtbl[ (menuitem - 4) >> 1 ];
-
-      memcpy(       buf +    1, "Absch.+=", 8 );
-      Display::hms( buf +    9, adj );
-      if (menuitem & 1) {
-        buf[7] = '-';
-        adj = -adj;
-      }
-      if (init)
-        secEnter = ctrl->sec;
-      else if (ctrl->sec > (secEnter + 3)) {
-        timeOff += adj;
-        if ((timeOff >= +43200L) || (timeOff <= -43200L)) {
-          timeOff -= adj;  // undo when out of range
-          memcpy( buf +    1, "Limit erreicht", 14 );
-        }
-      }
-
-      memcpy(       buf + 0x12, "Absch.: ", 8 );
-      Display::hms( buf + 0x1a, timeOff );
+      memcpy_P(     buf +    1, PSTR( "Auto-Nacht:    %" ), 16 );
+      Display::itoa( buf + 0x0e, 3, (((autoNight * 25) + 0x80) >> 8) & 0x7f );
+      buf[0x10] = '%';
+      memcpy_P(     buf + 0x12, PSTR( "Auto-Tag:      %" ), 16 );
+      Display::itoa( buf + 0x1f, 3, (((autoDay * 25) + 0x80) >> 8) & 0x7f );
+      buf[0x21] = '%';
       break;
+
+    default:
+      return 0;
   }
 
   buf[   0] = '|';
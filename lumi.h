@@ -4,6 +4,8 @@
 #include <Arduino.h>
 #include "ctrl.h"
 
+class Adc;
+
 class Lumi
 {
   public:
@@ -12,47 +14,120 @@ class Lumi
      ,DUSK
      ,DAWN
      ,MANUAL       // to perform manual backup
+     ,CHECKPOINT   // periodic backup of changed records
+    };
+    enum PARAM {   // settings to get/set
+      PAR_LUMSWITCH = 0  // 0..LUM_MAX
+     ,PAR_LUMDAWN        // 0..LUM_MAX
+     ,PAR_TIMEOFF        // secs: -TIMEOFF_MAX..+TIMEOFF_MAX
+     ,PAR_SECCORR        // secs: -SECCORR_MAX..+SECCORR_MAX
+     ,PAR_DAY            // day of year of last dawn: 1..Sun::DAYS (0: unknown - no model)
+     ,PAR_CLOCK          // secs after midnight (-1: unknown) / set: shifts secCorr by the difference
+    };
+    enum LIMIT {
+      LUM_MAX     = 1024   // 100% (menu steps may end here)
+     ,SECCORR_MAX = 14400  // +/-4h
     };
+    static long const TIMEOFF_MAX = 43199L;  // less than +/-12h
   private:
+    enum {
+      TOLERANCE = 5400  // secs: detection earlier than model is rejected / day light to replace by model
+     ,OBS_LEN   = 8     // nights in ring of observations
+     ,OBS_DAYS  = 16    // observations older than this are ignored
+     ,REJECT    = 900   // secs of midnight / 2 secs of day light: worse observations are dropped by fit
+     ,CONFIRM   = 30    // secs: luminance beyond threshold in sequence to detect dusk/dawn (deep night/light day)
+     ,STEP_MAX  = 30    // secs between evaluations far from thresholds
+     ,STEP_DET  = 5     // secs between evaluations at most, while confirming
+     ,STEP_LUM  = 8     // luminance distance to nearest threshold per sec of step
+     ,HIST_BINS = 16    // histogram of luminance: 2 bins per octave (bins 0, 1: 0..3, 4..7)
+     ,HIST_MIN  = 720   // minutes counted at least to calibrate
+     ,HIST_GAP  = 4     // bins between night and day plateau at least (2 octaves)
+     ,SCALE_ONE = 256   // manual setting: factor to calibrated threshold
+    };
+
+    struct observation {  // one night: dusk and following dawn detected
+      int16_t     mid;    // solar midnight + secCorr - midnight of clock (secs)
+      word        light;  // day light (2 secs) (0: not used)
+      byte        num;    // dayNum of dawn
+    };
+
     byte          pin;
     byte          status;    // 1: is night | 2: detect deep night/light day
-    byte          cntDetect; // how often did we detect sunrise/sunset in sequence (low pass filter)
-    byte          _rsvd;
+    boolean       detect;    // detecting sunrise/sunset (since secDetect) (low pass filter)
+    boolean       offDone;   // lamp switched off at secOff: not again on till dawn
+    byte          gen;       // generation: incremented on change of backup values
 
     word          lumSwitch; // luminance to switch on
     word          lumDawn;   // luminance to detect sunset/sunrise
     word          lumNight;  // luminance to detect deep night (start dawn detection)
     word          lumDay;    // luminance to detect light day (start dusk detection)
-    word          lumCurr;   // last read luminance value
+    word          lumCurr;   // last read luminance value (filtered)
+    word          autoDawn;  // calibrated thresholds
+    word          autoNight; // (0: not yet calibrated - lumNight, lumDay by lumDawn)
+    word          autoDay;
+    word          sclSwitch; // manual setting: lumSwitch = autoDawn * sclSwitch / SCALE_ONE
+    word          sclDawn;   // manual setting: lumDawn   = autoDawn * sclDawn   / SCALE_ONE
+    word          hist[HIST_BINS];  // minutes per luminance bin (aged at dawn)
+    word          day;       // day of year of last dawn (0: unknown)
+    byte          dayNum;    // counts dawns (and days without dawn) - age of observations
+    byte          obsHead;   // next observation to write
+    observation   obs[OBS_LEN];  // ring of last nights
 
     short         secCorr;   // correction to calculate midnight (we assume DST)
       signed long timeOff;   // daytime, when to switch off (negative: before astron. midnight)
 
     unsigned long secOff;    // ctrl->sec, when to switch off today (calculated, when switched on)
+    unsigned long secNext;   // ctrl->sec of next evaluation of luminance
+    unsigned long secDetect; // ctrl->sec of first detection in sequence
     unsigned long dayLight;  // length of day light 0..86400
+    unsigned long dayPred;   // length of day light by model (0: no model)
 
     unsigned long midnight;  // calculated sec counter value of next midnight
     unsigned long secDusk;   // sunset time (secs counter)
     unsigned long secDawn;   // sunrise time (secs counter) (==> midnight somewhere at (secDusk + secDawn) / 2)
 
-    unsigned long secEnter;  // ctrl->sec, when we did enter the menu item "adjust timeOff/secCorr"
-
     Ctrl        * ctrl;
+    Adc         * adc;       // samples luminance by interrupt
+    byte          chan;      // Adc channel
+
+    void          switchOn( unsigned long off );  // lamp on, unless off (+ timeOff) passed
+    void          calibrate(void); // auto* from histogram
+    void          apply(void);     // lum* thresholds of auto* and manual settings
+    word          plateau( byte bin );  // luminance at peak of histogram
+    static byte   bin( word lum );  // histogram bin of luminance
+    static word   scale( word lum, word scl );  // lum * scl / SCALE_ONE (at most LUM_MAX)
+    byte          step(void);      // secs to next evaluation: the closer to a threshold, the shorter
+    boolean       confirm( boolean hit );  // hit in sequence for CONFIRM secs
+    void          predict(void);   // dayPred of day
+    void          nextDay(void);   // at dawn: count days since last dawn
+    void          observe( unsigned long mid, unsigned long light );  // at dawn: add last night to ring
+    boolean       fit( boolean light, signed char at, long & val );   // trend of ring at day 'at' (0: last dawn) / false: empty
+    void          shift( long secs );  // clock frame moved: midnights of ring
+    boolean       early( unsigned long expected );  // detection too early (model) / expected: secs counter
+    unsigned long plausible( unsigned long measured );  // day light measured or by model, when too different
 
   public:
     Lumi( byte pin );  // analog pin!
-    void    setup( Ctrl * ctrl );
+    void    setup( Ctrl * ctrl, Adc * adc );
     byte    secLoop(void);      // read luminance and return true on dusk and dawn
 
     boolean       night() { return status & 1; };
     unsigned long dusk()  { return secDusk; };
     unsigned long dawn()  { return secDawn; };
+    word          lum()   { return lumCurr; };
+    byte          state() { return status; };
+    byte    generation() { return gen; };
+    long    clock(void);        // secs after midnight 0..86399 / -1: midnight unknown
+
+    long    get( byte par );
+    boolean set( byte par, long val );  // false: out of range
 
+    enum { BACKUP_LEN = 22 + sizeof(obs) + sizeof(hist) };  // bytes written by backup()
     int     backup( int addr );      // in: start address behind length / return: end address + 1
     void    restore( int addr, uint8_t len );
 
-    char  * showTime( char * buf, byte menuitem, byte init );  // time as calculated by dusk and dawn
-    char  * showDown( char * buf, byte menuitem, byte init );  // down = dusk+dawn ;-)
+    char  * showTime( char * buf, byte menuitem );  // time as calculated by dusk and dawn
+    char  * showDown( char * buf, byte menuitem );  // down = dusk+dawn ;-)
 };
 
 #endif
@@ -0,0 +1,223 @@
+#include <util/crc16.h>  // _crc16_update(): Modbus crc
+
+#include "modbus.h"
+#include "relay.h"
+#include "circuit.h"    // Circuit::PUMP, Circuit::LAMP
+#include "lumi.h"
+#include "temp.h"
+#include "switch.h"     // Switch::TEMP
+
+Modbus::Modbus()
+  : state( ST_RX )
+  , len(   0 )
+  , pos(   0 )
+{
+}
+
+void Modbus::setup( Ctrl * ctrlArg )
+{
+  ctrl = ctrlArg;
+
+  UBRR0  = (F_CPU / 16 / BAUD) - 1;
+  UCSR0A = 0;
+  UCSR0C = (1 << UPM01) | (3 << UCSZ00);    // 8 data bits, even parity, 1 stop bit
+  UCSR0B = (1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0);
+
+  TCCR2A = 0;                                      // normal mode
+  TCCR2B = (1 << CS22) | (1 << CS21) | (1 << CS20); // clk/1024
+  OCR2A  = TICKS_T35;
+}
+
+void Modbus::rx(void)
+{
+  byte const err = UCSR0A & ((1 << FE0) | (1 << DOR0) | (1 << UPE0));
+  byte const c   = UDR0;
+
+  if (state >= ST_FRAME)
+    return;  // not yet processed or echo of response: ignore
+
+  if (err || (len && (TCNT2 > TICKS_T15)) || (len >= BUF_LEN))
+    state = ST_BAD;
+  else
+    buf[len++] = c;
+
+  TCNT2  = 0;             // restart gap timer
+  TIFR2  = (1 << OCF2A);
+  TIMSK2 = (1 << OCIE2A);
+}
+
+void Modbus::gap(void)
+{
+  TIMSK2 = 0;
+  if ((state == ST_RX) && len)
+    state = ST_FRAME;
+  else if (state == ST_BAD) {
+    state = ST_RX;
+    len   = 0;
+  }
+}
+
+void Modbus::tx(void)
+{
+  UDR0 = buf[pos++];
+  if (pos == len)
+    UCSR0B = (UCSR0B & ~(1 << UDRIE0)) | (1 << TXCIE0);  // last byte: wait for end of transmission
+}
+
+void Modbus::txDone(void)
+{
+  UCSR0B &= ~(1 << TXCIE0);
+  len   = 0;
+  state = ST_RX;
+}
+
+void Modbus::loop(void)
+{
+  if (state != ST_FRAME)
+    return;
+
+  byte const n = process();
+  if (! n) {
+    len   = 0;
+    state = ST_RX;
+    return;
+  }
+
+  word crc = 0xffff;
+  for (byte i = 0; i < n; ++i)
+    crc = _crc16_update( crc, buf[i] );
+  buf[n]     = (uint8_t) crc;
+  buf[n + 1] = (uint8_t) (crc >> 8);
+
+  pos   = 0;
+  len   = n + 2;
+  state = ST_TX;
+  UCSR0A |= (1 << TXC0);     // clear stale "transmit complete"
+  UCSR0B |= (1 << UDRIE0);   // tx() sends the response
+}
+
+byte Modbus::process(void)
+{
+  if ((len < 4) || ((buf[0] != SLAVE_ID) && buf[0]))
+    return 0;  // too short / other slave
+
+  word crc = 0xffff;
+  for (byte i = 0; i < len; ++i)
+    crc = _crc16_update( crc, buf[i] );
+  if (crc)
+    return 0;  // crc over frame incl. crc is 0
+
+  word const reg = (buf[2] << 8) | buf[3];
+  word const cnt = (buf[4] << 8) | buf[5];
+  byte       exc = 0;
+
+  switch (buf[1]) {
+    case 3:   // read holding registers
+    case 4:   // read input registers
+    {
+      word const count = (buf[1] == 3) ? HOLDING_COUNT : INPUT_COUNT;
+      if ((len != 8) || (cnt < 1) || (cnt > MAX_READ))
+        exc = 3;
+      else if ((reg >= count) || (cnt > count - reg))  // reg + cnt may overflow
+        exc = 2;
+      else {
+        buf[2] = cnt * 2;
+        for (byte i = 0; i < cnt; ++i) {
+          word const val = (buf[1] == 3) ? holding( reg + i ) : input( reg + i );
+          buf[3 + 2 * i] = val >> 8;
+          buf[4 + 2 * i] = val;
+        }
+      }
+      break;
+    }
+
+    case 6:   // write single register (cnt is value)
+      if (len != 8)
+        exc = 3;
+      else if (reg >= HOLDING_COUNT)
+        exc = 2;
+      else if (! holding( reg, cnt ))
+        exc = 3;
+      break;
+
+    case 16:  // write multiple registers
+      if ((len != 9 + buf[6]) || (cnt < 1) || (buf[6] != cnt * 2))
+        exc = 3;
+      else if ((reg >= HOLDING_COUNT) || (cnt > HOLDING_COUNT - reg))  // reg + cnt may overflow
+        exc = 2;
+      else
+        for (byte i = 0; i < cnt; ++i)
+          if (! holding( reg + i, (buf[7 + 2 * i] << 8) | buf[8 + 2 * i] )) {
+            exc = 3;
+            break;
+          }
+      break;
+
+    default:
+      exc = 1;  // illegal function
+      break;
+  }
+
+  if (! buf[0])
+    return 0;  // broadcast: no response
+
+  if (exc) {
+    buf[1] |= 0x80;
+    buf[2]  = exc;
+    return 3;
+  }
+  return (buf[1] <= 4) ? (3 + buf[2]) : 6;  // read: data / write: echo of address and count
+}
+
+word Modbus::input( byte reg )
+{
+  Relay * const relay = & ctrl->relays[(reg < 17) ? Circuit::PUMP : Circuit::LAMP];
+
+  switch (reg) {
+    case 10: return ctrl->temp->sensorsOk();
+    case 11: return ctrl->temp->result();
+    case 12:
+    case 17: return relay->isOn() | (relay->mode() << 4);
+    case 13:
+    case 18: return relay->today() >> 16;
+    case 14:
+    case 19: return relay->today();
+    case 15:
+    case 20: return relay->total() >> 16;
+    case 16:
+    case 21: return relay->total();
+    case 22: return ctrl->lumi->lum();
+    case 23: return ctrl->lumi->state();
+    case 24: return ctrl->sec >> 16;
+    case 25: return ctrl->sec;
+  }
+  if (reg < Temp::SENSOR_COUNT)
+    return ctrl->temp->raw( reg ).raw();
+  return ctrl->temp->avg( reg - Temp::SENSOR_COUNT ).raw();
+}
+
+word Modbus::holding( byte reg )
+{
+  switch (reg) {
+    case 4:  return ctrl->lumi->get( Lumi::PAR_LUMSWITCH );
+    case 5:  return ctrl->lumi->get( Lumi::PAR_LUMDAWN );
+    case 6:  return ctrl->relays[Circuit::PUMP].mode();
+    case 7:  return ctrl->relays[Circuit::LAMP].mode();
+    default: return ctrl->temp->get( reg );  // Temp::PARAM
+  }
+}
+
+boolean Modbus::holding( byte reg, word val )
+{
+  switch (reg) {
+    case 4:  return ctrl->lumi->set( Lumi::PAR_LUMSWITCH, val );
+    case 5:  return ctrl->lumi->set( Lumi::PAR_LUMDAWN,   val );
+    case 6:
+    case 7:
+      if (val > Switch::TEMP)
+        return false;
+      ctrl->relays[(reg == 6) ? Circuit::PUMP : Circuit::LAMP].swMode( val );
+      return true;
+    default: return ctrl->temp->set( reg, val );  // Temp::PARAM
+  }
+}
@@ -0,0 +1,77 @@
+#ifndef Modbus_h
+#define Modbus_h
+
+#include <Arduino.h>
+#include "ctrl.h"
+
+// Modbus RTU slave on the UART (9600 baud 8E1), when MODBUS is defined in ctrl.h
+// (uses USART0 and Timer2 interrupts directly - Serial must not be used)
+//
+// functions: 03 read holding, 04 read input, 06 write single, 16 write multiple registers
+// (max. MAX_READ registers per read request)
+//
+// input registers:
+//    0.. 4  temperature in 1/16 C: sol, pool, ins, air, box (0x7fff: not yet read)
+//    5.. 9  low pass filtered temperature, same order
+//   10      bit mask of sensors read in current cycle
+//   11      last result of Temp::finalize()
+//   12      pump: bit 0: on / bits 4..7: switch mode (Switch::MODE)
+//   13,14   pump: seconds on today (high, low word)
+//   15,16   pump: seconds on since boot up (high, low word)
+//   17..21  lamp: as pump
+//   22      luminance
+//   23      Lumi status (bit 0: night / bit 1: detecting dusk or dawn)
+//   24,25   seconds since boot up (high, low word)
+//
+// holding registers (written with the limits of the menu, exception 03 otherwise):
+//    0.. 3  temperature thresholds 0..9: pausing, b4start, running, b4stop
+//    4, 5   luminance to switch on / to detect dusk and dawn: 0..1024
+//    6, 7   switch mode of pump, lamp (Switch::MODE: 0 off, 1 on, 2 auto, 3 temporary on)
+
+class Modbus
+{
+  private:
+    enum {
+      SLAVE_ID   = 1
+     ,BAUD       = 9600
+     ,BUF_LEN    = 64          // request and response
+     ,MAX_READ   = (BUF_LEN - 5) / 2
+
+     ,INPUT_COUNT   = 26
+     ,HOLDING_COUNT = 8
+
+     ,USEC_CHAR  = 11000000L / BAUD             // start, 8 data, parity, stop bit
+     ,USEC_TICK  = 1024000000L / F_CPU          // Timer2 at clk/1024
+     ,TICKS_T35  = (USEC_CHAR * 7 / 2) / USEC_TICK      // silence: end of frame
+     ,TICKS_T15  = (USEC_CHAR * 5 / 2) / USEC_TICK      // char + 1.5 chars silence: broken frame
+    };
+    enum STATE {
+      ST_RX = 0    // receiving
+     ,ST_BAD       // receiving broken frame (discarded at end of frame)
+     ,ST_FRAME     // frame to process by loop()
+     ,ST_TX        // sending response
+    };
+
+    volatile byte state;
+    volatile byte len;      // received / to send
+    volatile byte pos;      // next byte to send
+    uint8_t       buf[BUF_LEN];
+    Ctrl        * ctrl;
+
+    byte    process(void);                  // return: response length without crc (0: none)
+    word    input( byte reg );
+    word    holding( byte reg );
+    boolean holding( byte reg, word val );  // false: out of range
+
+  public:
+    Modbus();
+    void    setup( Ctrl * ctrl );
+    void    loop(void);    // process received frame and start sending the response
+
+    void    rx(void);      // USART_RX_vect:     store byte, restart gap timer
+    void    tx(void);      // USART_UDRE_vect:   send next byte
+    void    txDone(void);  // USART_TX_vect:     response sent
+    void    gap(void);     // TIMER2_COMPA_vect: 3.5 chars silence
+};
+
+#endif
@@ -1,76 +1,137 @@
 #include <EEPROM.h>
 #include <OneWire.h>
-#include <LiquidCrystal.h>
 #include <avr/wdt.h>
 
 #include "ctrl.h"
 #include "version.h"
 
+#include "lcd.h"        // HD44780 driver (queued output, busy flag polling)
 #include "display.h"    // LCD wrapper (info/menu/duplicate content on serial output)
 #include "switch.h"     // manual switches (de-chatter and call relay->...)
 #include "relay.h"      // relay control (on/off and duration, "total on since ...")
+#include "circuit.h"    // switch/relay pairs (table of pins, automation, start of day)
 #include "lumi.h"       // luminance ctrl (dusk,dawn,midnight,status...)
+#include "adc.h"        // analog channels sampled by interrupt
 #include "temp.h"       // temperature reading
+#include "journal.h"    // switching events in EEPROM
+#include "events.h"     // side effects posted by sub systems (delivered by loop)
+#ifdef TELEMETRY
+#include "telemetry.h"  // binary status records on serial output
+#include "log.h"        // debug messages (sent by telemetry)
+#endif
+#ifdef COMMANDS
+#include "cmd.h"        // text commands on serial input
+#endif
+#ifdef MODBUS
+#include "modbus.h"     // Modbus RTU slave
+#endif
 
 OneWire         ow(  PIN_OneWire );
 
 #ifdef KEYPAD
-LiquidCrystal   lcd( PIN_LCD_RS,               PIN_LCD_Ena,
+Lcd             lcd( PIN_LCD_RS,               PIN_LCD_Ena,  // no RW: fixed delays
                      PIN_LCD_DB4, PIN_LCD_DB5, PIN_LCD_DB6, PIN_LCD_DB7 );
 #else
-LiquidCrystal   lcd( PIN_LCD_RS,  PIN_LCD_RW,  PIN_LCD_Ena,
+Lcd             lcd( PIN_LCD_RS,  PIN_LCD_RW,  PIN_LCD_Ena,  // RW: poll busy flag
                      PIN_LCD_DB4, PIN_LCD_DB5, PIN_LCD_DB6, PIN_LCD_DB7 );
 #endif
 
 Display  display;
-Switch   pumpSwitch( PIN_PumpSwitch );
-Switch   lampSwitch( PIN_LampSwitch );
-Relay    pumpRelay(  PIN_PumpRelay );
-Relay    lampRelay(  PIN_LampRelay );
+Switch   switches[CIRCUITS];
+Relay    relays[CIRCUITS];
 Lumi     lumi(       PIN_Luminance );
+Adc      adc;
+#ifdef KEYPAD
+byte     keypadChan;  // Adc channel
+#endif
 Temp     temp;
+Journal  journal;
+Events   events;
+#ifdef TELEMETRY
+Telemetry telemetry;
+#endif
+#ifdef COMMANDS
+Cmd      cmd;
+#endif
+#ifdef MODBUS
+Modbus   modbus;
+#endif
 
 Ctrl     ctrl( & display
-              ,& pumpSwitch
-              ,& lampSwitch
-              ,& pumpRelay
-              ,& lampRelay
+              ,switches
+              ,relays
               ,& lumi
-              ,& temp );
+              ,& temp
+              ,& journal
+              ,& events );
 
 void setup(void)
 {
-  pumpRelay.init();
-  lampRelay.init();
-  pumpSwitch.init();
-  lampSwitch.init();
+  Circuits<>::init( & ctrl );  // relays off
+  pinMode( PIN_PowerFail, INPUT_PULLUP );  // supervisor output is open drain
 
-  DEBUG_EXPR( Serial.begin(9600) )
-  DEBUG_EXPR( Serial.println( "Piscino " VERSION " - (c) Holger Galuschka" ) )
+#ifdef TELEMETRY
+  Serial.begin(9600);
+  telemetry.setup(  & ctrl );
+#endif
+#ifdef COMMANDS
+  Serial.begin(9600);
+  cmd.setup(        & ctrl );
+#endif
+#ifdef MODBUS
+  modbus.setup(     & ctrl );
+#endif
+  DEBUG_EXPR( Log::put( Log::MSG_BOOT ) )
 
-  lcd.begin( 16, 2 );  // 16 Zeichen / 2 Zeilen
-  display.setup(    & ctrl, & lcd );
+  events.setup(     & ctrl );  // before sub systems may post
+  journal.setup(    & ctrl );  // before relays may switch
 
-  pumpRelay.setup(  & ctrl, Display::NUM_PUMP );
-  lampRelay.setup(  & ctrl, Display::NUM_LAMP );
+  lcd.begin();  // 16 Zeichen / 2 Zeilen
+  display.setup(    & ctrl, & lcd );
 
-  pumpSwitch.setup( & ctrl, Display::NUM_PUMP );
-  lampSwitch.setup( & ctrl, Display::NUM_LAMP );
+  Circuits<>::setup( & ctrl );
 
-  lumi.setup(       & ctrl );        // lampRelay->autoOn() used, to switch lamp
-  temp.setup(       & ctrl, & ow );  // pumpRelay->autoOn() used, to switch filter pump
+  lumi.setup(       & ctrl, & adc ); // relay->autoOn() used, to switch lamp
+#ifdef KEYPAD
+  keypadChan = adc.add( PIN_Keypad, Adc::FAST );  // about 1 kHz
+#endif
+  adc.start();
+  temp.setup(       & ctrl, & ow );  // relay->autoOn() used, to switch filter pump
 
   ctrl.restore();  // restore values from last backup (at dawn or driven manual by menu)
 
+  ctrl.pfUpdate();
+  PCMSK1 |= (1 << PCINT9);  // PIN_PowerFail is A1 = PC1
+  PCICR  |= (1 << PCIE1);
+
   wdt_enable( WDTO_250MS );
   wdt_reset();
 }
 
+ISR( PCINT1_vect )  // PIN_PowerFail changed
+{
+  if (digitalRead( PIN_PowerFail ) == LOW)
+    ctrl.powerFail();  // save counters while the capacitors hold up
+}
+
+ISR( ADC_vect )  // conversion complete: next channel
+{
+  adc.sample();
+}
+
+#ifdef MODBUS
+ISR( USART_RX_vect )     { modbus.rx(); }
+ISR( USART_UDRE_vect )   { modbus.tx(); }
+ISR( USART_TX_vect )     { modbus.txDone(); }
+ISR( TIMER2_COMPA_vect ) { modbus.gap(); }  // 3.5 chars silence: end of frame
+#endif
+
 void loop(void)
 {
   static unsigned long usecOfNextSec =  0;  // micros(), when next second is expected
 
   wdt_reset();
+  Ctrl::crumb = Ctrl::CRUMB_LOOP;
 
   long diff = micros() - usecOfNextSec; // using micros to run max. about 2000 times on accidential value
   if (diff >= 0)
@@ -85,16 +146,34 @@ void loop(void)
 
     display.secLoop();   // fall back from menu to info / go off
 
-    pumpRelay.secLoop(); // may fall back from "temporary on"
-    lampRelay.secLoop(); // may fall back from "temporary on"
+    Circuits<>::secLoop( & ctrl );  // relays may fall back from "temporary on"
+    ctrl.pfUpdate();     // counters to save on power fail
 
     ctrl.backup( lumi.secLoop() );  // read luminance (returns true on dusk and dawn)
+#ifdef TELEMETRY
+    telemetry.secLoop(); // status record every minute
+#endif
   }
 
   temp.loop();
+  events.dispatch();  // a few posted side effects (display info, relays)
+  Ctrl::crumb = Ctrl::CRUMB_LCD;
+  lcd.loop();  // send next queued char to LCD
+  Ctrl::crumb = Ctrl::CRUMB_SERIAL;
+#ifdef TELEMETRY
+  telemetry.loop();  // pass frame to UART TX buffer (never waits)
+#endif
+#ifdef COMMANDS
+  cmd.loop();  // bounded: one reply line or a few received chars
+#endif
+#ifdef MODBUS
+  modbus.loop();  // process received frame (receive and send by interrupts)
+#endif
+
+  Ctrl::crumb = Ctrl::CRUMB_LOOP;
 
 #ifdef KEYPAD
-  ctrl.keypad = analogRead( 0 );
+  ctrl.keypad = adc.raw( keypadChan );  // latest sample (converted in background)
 #if 0
   static int oldKey = 0x3ff;
   if (oldKey != ctrl.keypad) {
@@ -105,16 +184,5 @@ void loop(void)
 #endif
 #endif
 
-  switch (pumpSwitch.loop()) {
-    case Switch::NOTE_MENU:    display.toggleMode();                  break;
-    case Switch::NOTE_KEY:     display.key( Display::NUM_PUMP );      break;
-    case Switch::NOTE_SWMODE:  pumpRelay.swMode( pumpSwitch.mode() ); break;
-    // pump switch may pressed somewhere else -> not to restart (?)
-  }
-  switch (lampSwitch.loop()) {
-    case Switch::NOTE_MENU:    display.toggleMode();                  break;
-    case Switch::NOTE_KEY:     display.key( Display::NUM_LAMP );      break;
-    case Switch::NOTE_SWMODE:  lampRelay.swMode( lampSwitch.mode() ); break;
-    case Switch::NOTE_TIMEOUT: display.restart();                     break;
-  }
+  Circuits<>::loop( & ctrl );  // switches: menu, keys and switch modes
 }
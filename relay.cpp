@@ -2,14 +2,16 @@
 #include "display.h"
 #include "switch.h"  // Switch::AUTO
 #include "lumi.h"    // lumi->dusk(), lumi->dawn()
+#include "journal.h" // switching events
+#include "events.h"  // display info is posted
 
 
-Relay::Relay( byte pinArg )
-  : pin( pinArg )
-  , on(       0 )
+Relay::Relay()
+  : on(       0 )
   , autoon(   0 )
   , swmode( Switch::AUTO )
   , prev(   Switch::AUTO )
+  , gen(    0 )
   , timeout( 60 )  // 60 minutes: temporary switch on for 1 hour
   , switched( 0 )
   , run(      0 )
@@ -17,26 +19,53 @@ Relay::Relay( byte pinArg )
   , todayOn(  0 )
   , totalOn(  0 )
   , refSec(   0 )
+  , onSecs(   0 )
+  , switches( 0 )
+  , dayHead(  0 )
 {
+  memset( hourMin, 0, sizeof(hourMin) );
 }
 
-void Relay::init(void) // init PIN mode and switch off
+void Relay::init( byte pinArg ) // init PIN mode and switch off
 {
+  pin = pinArg;
   digitalWrite( pin, HIGH );  // hopefully the relay stays open during bootup
   pinMode( pin, OUTPUT );
   digitalWrite( pin, HIGH );  // LOW active ==> HIGH to switch off
 }
 
-void Relay::setup( Ctrl * ctrlArg, byte infonumArg )
+void Relay::setup( Ctrl * ctrlArg, byte infonumArg, byte evSwitchArg, byte evModeArg, int eeDaysArg )
 {
-  ctrl    = ctrlArg;
-  infonum = infonumArg;
+  ctrl     = ctrlArg;
+  infonum  = infonumArg;
+  evSwitch = evSwitchArg;
+  evMode   = evModeArg;
+  eeDays   = eeDaysArg;
+
+  // head: end mark behind a day - saveDay() writes the next end mark first,
+  // the second one (also across slot 0) follows an end mark
+  for (dayHead = 0; dayHead <= DAYS; ++dayHead)
+    if (   ((uint16_t) Ctrl::read2( eeDays + dayHead * 2 ) == DAY_END)
+        && ((uint16_t) Ctrl::read2( eeDays + ((dayHead + DAYS) % (DAYS + 1)) * 2 ) != DAY_END))
+      break;
+
+  if (dayHead > DAYS) {  // no day in ring (never used)
+    dayHead = 0;
+    Ctrl::save( eeDays, (uint16_t) DAY_END );
+  }
 
-  ctrl->display->info( infonum, swmode | (autoon << 2) | (on << 3) );
+  ctrl->events->post( Events::EV_INFO, infonum, swmode | (autoon << 2) | (on << 3) );
 }
 
 void Relay::secLoop(void)
 {
+  if (on && (++onSecs >= 60)) {  // profile of day: relative to midnight by dusk and dawn
+    onSecs = 0;
+    long const t = ctrl->lumi->clock();
+    if ((t >= 0) && (hourMin[t / 3600] < 0xff))
+      ++hourMin[t / 3600];
+  }
+
   if (swmode == Switch::TEMP) {
     long diff = millis() - tempStop;
     if (diff >= 0)
@@ -65,8 +94,10 @@ void Relay::swMode( byte swmodeArg )
     prev = swmode; // save last used OFF or AUTO mode (to what we have to switch back)
 
   swmode = swmodeArg;
+  ++gen;
+  ctrl->journal->put( evMode, swmode );
   turn( newOn );
-  ctrl->display->info( infonum, swmode | (autoon << 2) | (on << 3) );
+  ctrl->events->post( Events::EV_INFO, infonum, swmode | (autoon << 2) | (on << 3) );
 }
 
 void Relay::autoOn( byte autoonArg )  // automatic switching
@@ -78,19 +109,11 @@ void Relay::autoOn( byte autoonArg )  // automatic switching
   if (swmode == Switch::AUTO)
     turn( autoon );
 
-  ctrl->display->info( infonum, swmode | (autoon << 2) | (on << 3) );
+  ctrl->events->post( Events::EV_INFO, infonum, swmode | (autoon << 2) | (on << 3) );
 }
 
-void Relay::night( byte isNight )
+void Relay::newDay(void)
 {
-  if (infonum == Display::NUM_LAMP) {
-    if (! isNight)  // -> dawn
-      return;  // lamp: reference is last dusk
-  } else {
-    if (isNight)  // -> dusk
-      return;  // pump: reference is last dawn
-  }
-
   if (on) {
     unsigned long now = millis();
     unsigned long time = (now - switched);
@@ -100,9 +123,11 @@ void Relay::night( byte isNight )
     todayOn += time;
     paused = 0; // indicate no pause (run while dusk/dawn)
   }
+  saveDay();
   totalOn += (todayOn + 500L) / 1000L;
   todayOn  = 0;
   refSec   = ctrl->sec;
+  ++gen;
 }
 
 void Relay::turn( byte onArg )
@@ -112,6 +137,7 @@ void Relay::turn( byte onArg )
 
   on = onArg;
   digitalWrite( pin, on ? LOW : HIGH );  // LOW active ==> LOW to switch on
+  ctrl->journal->put( evSwitch, on );
 
   unsigned long now  = millis();
   unsigned long time = (now - switched);
@@ -123,8 +149,44 @@ void Relay::turn( byte onArg )
   if (! on) {  // we switch off -> add this time running
     run = time;
     todayOn += time;
-  } else
+    ++gen;
+  } else {
     paused = time;
+    if (switches < 0xff)
+      ++switches;
+  }
+}
+
+void Relay::saveDay(void)
+{
+  unsigned long mins = (todayOn + 30000L) / 60000L;
+  if (mins > DAY_MIN_MAX)
+    mins = DAY_MIN_MAX;  // e.g. no dusk/dawn for days
+  word const packed = mins | ((word) ((switches < DAY_SW_MAX) ? switches : (byte) DAY_SW_MAX) << DAY_SW_SHIFT);
+
+  // end mark first: power gone before the day is written leaves the old one valid
+  byte const next = (dayHead + 1) % (DAYS + 1);
+  Ctrl::save( eeDays + next    * 2, (uint16_t) DAY_END );
+  Ctrl::save( eeDays + dayHead * 2, (uint16_t) packed );
+  dayHead = next;
+
+  for (byte i = 0; i < HOURS; ++i)
+    hourMin[i] -= hourMin[i] >> 2;  // age profile: 3/4 per day
+  switches = 0;
+}
+
+boolean Relay::day( byte idx, word & minutes, byte & sw )
+{
+  if (idx >= DAYS)
+    return false;
+
+  byte const slot   = (dayHead + DAYS - idx) % (DAYS + 1);
+  word const packed = Ctrl::read2( eeDays + slot * 2 );
+  if (packed == DAY_END)
+    return false;  // end mark or not yet written
+  minutes = packed & ((1 << DAY_SW_SHIFT) - 1);
+  sw      = packed >> DAY_SW_SHIFT;
+  return true;
 }
 
 unsigned long Relay::running()
@@ -156,29 +218,65 @@ unsigned long Relay::total()
   return totalOn + today();
 }
 
+byte Relay::generation(void)
+{
+  if (on)
+    ++gen;  // todayOn of backup() includes the current run
+  return gen;
+}
+
+
+long Relay::get( byte /*par*/ )
+{
+  return timeout;
+}
+
+boolean Relay::set( byte /*par*/, long val )
+{
+  if ((val < TIMEOUT_MIN) || (val > TIMEOUT_MAX))
+    return false;
+  timeout = val;
+  ++gen;
+  return true;
+}
 
 int Relay::backup( int addr )
 {
   addr = Ctrl::save( addr, (uint32_t) totalOn );
-  addr = Ctrl::save( addr, (uint32_t) todayOn );
+  addr = Ctrl::save( addr, (uint32_t) (todayOn + running()) );
   addr = Ctrl::save( addr, (uint16_t) timeout );
   addr = Ctrl::save( addr, (uint8_t)  swmode  );
+  addr = Ctrl::save( addr, (uint8_t)  switches );
+  addr = Ctrl::save( addr, hourMin, sizeof(hourMin) );
   return addr;
 }
 
 void Relay::restore( int addr, uint8_t len )
 {
-  if (len >= 10) {
+  if (len >= 8) {  // 8: power fail record
     totalOn = Ctrl::read4( addr );
     todayOn = Ctrl::read4( addr + 4 );
-    timeout = Ctrl::read2( addr + 8 );
-    if (len >= 11) {
-      swmode = Ctrl::read1( addr + 10 );
+    if (len >= 10) {
+      timeout = Ctrl::read2( addr + 8 );
+      if (len >= 11) {
+        swmode = Ctrl::read1( addr + 10 );
+        if (len >= 12 + sizeof(hourMin)) {
+          switches = Ctrl::read1( addr + 11 );
+          Ctrl::readN( addr + 12, hourMin, sizeof(hourMin) );
+        }
+      }
     }
   }
 }
 
-char * Relay::show( char * buf, byte menuitem, byte init, const char * name )
+uint8_t * Relay::counters( uint8_t * buf )
+{
+  buf = Ctrl::put( buf, totalOn );
+  buf = Ctrl::put( buf, todayOn + running() );  // current run counts
+  return buf;
+}
+
+char * Relay::show( char * buf, byte menuitem, const char * name )
 {
   // |0123456789abcdef|
   // |B.ein: 2:34 h:mm|
@@ -189,74 +287,87 @@ char * Relay::show( char * buf, byte menuitem, byte init, const char * name )
   buf[0x22] = '|';
   buf[0x23] = 0;
 
-  static byte adjtbl[] = { 60, 10, 1 };  // 1 hour, 10 min, 1 min
-  short adj;
-
   switch (menuitem) {
     case 1:
       {
-        byte const len = strlen( name );
-        memcpy( buf + 1, name, len );
+        byte const len = strlen_P( name );
+        memcpy_P( buf + 1, name, len );
         memset( buf + 1 + len, ' ', 0x10 - len );
       }
-      memcpy( buf + 0x12, on ? "ein" : "aus", 3 );
-      memcpy( buf + 0x15, ":     ", 6 );
+      memcpy_P( buf + 0x12, on ? PSTR( "ein" ) : PSTR( "aus" ), 3 );
+      memcpy_P( buf + 0x15, PSTR( ":     " ), 6 );
       Display::dhms( buf + 0x1b, (millis() - switched + 500L) / 1000L );
       break;
 
     case 2:
-      memcpy( buf +    1, "vorher:  ", 9 );
+      memcpy_P( buf +    1, PSTR( "vorher:  " ), 9 );
       Display::dhms( buf +   10, (run    + 500L) / 1000L );
-      memcpy( buf + 0x12, "Pause:   ", 9 );
+      memcpy_P( buf + 0x12, PSTR( "Pause:   " ), 9 );
       Display::dhms( buf + 0x1b, (paused + 500L) / 1000L );
       break;
 
     case 3:
-      memcpy( buf +    1, "heute:   ", 9 );
+      memcpy_P( buf +    1, PSTR( "heute:   " ), 9 );
       Display::dhms( buf +   10, today() );
-      memcpy( buf + 0x12, "gesamt:  ", 9 );
+      memcpy_P( buf + 0x12, PSTR( "gesamt:  " ), 9 );
       Display::dhms( buf + 0x1b, total() );
       break;
 
     case 4:
-      memcpy( buf +    1, "heute:   ", 9 );
+      memcpy_P( buf +    1, PSTR( "heute:   " ), 9 );
       Display::percentage( buf +   10, today(), ctrl->sec + (refSec ? -refSec : ctrl->todayOn) );
-      memcpy( buf + 0x12, "gesamt:  ", 9 );
+      memcpy_P( buf + 0x12, PSTR( "gesamt:  " ), 9 );
       Display::percentage( buf + 0x1b, total(), ctrl->sec + ctrl->totalOn );
       break;
 
+    case 5:
+      // |0123456789abcdef|
+      // | 0h ..2579987421|  <- minutes on per hour after midnight (9: most)
+      // |12h 6420........|
+      {
+        byte max = 1;
+        for (byte h = 0; h < HOURS; ++h)
+          if (hourMin[h] > max)
+            max = hourMin[h];
+
+        memcpy_P( buf +    1, PSTR( " 0h " ), 4 );
+        memcpy_P( buf + 0x12, PSTR( "12h " ), 4 );
+        for (byte h = 0; h < HOURS; ++h)
+          buf[(h < 12) ? 5 + h : 0x16 - 12 + h] = hourMin[h] ? '0' + ((hourMin[h] * 9 + max - 1) / max) : '.';
+      }
+      break;
+
     default:
-      if (menuitem > 10)
-        return 0;
+      return 0;
+  }
 
-      adj = adjtbl[ (menuitem - 5) >> 1 ];
+  buf[0x11] = '|';
+  buf[0x22] = '|';
+  buf[0x23] = 0;
+  return buf;
+}
 
-      memcpy(       buf +    1, "Ausz. +=", 8 );
-      Display::hms( buf +    9, (short) adj * 60 );
-      if (! (menuitem & 1)) {
-        buf[7] = '-';
-        adj = -adj;
-      }
+char * Relay::showDay( char * buf, byte menuitem )
+{
+  // |Tag -1:   12 mal|  <- switched on
+  // |ein:      2:34 h|
 
-      if (init)
-        secEnter = ctrl->sec;
-      else if (ctrl->sec > (secEnter + 3)) {
-        if (adj < 0)
-          if (timeout <= -adj)  // min.: 1 minute
-            memcpy( buf +    1, "Limit erreicht  ", 16 );
-          else
-            timeout += adj;
-        else
-          if ((timeout + adj) > 360)  // max.: 6h
-            memcpy( buf +    1, "Limit erreicht  ", 16 );
-          else
-            timeout += adj;
-      }
-      memcpy(       buf + 0x12, "Auszeit:", 8 );
-      Display::hms( buf + 0x1a, timeout * 60 );
-      break;
-  }
+  word minutes;
+  byte sw;
+  if (! day( menuitem - 1, minutes, sw ))
+    return 0;
+
+  memset( buf + 1, ' ', 0x21 );
+  memcpy_P( buf +    1, PSTR( "Tag -" ), 5 );
+  Display::itoa( buf +  6, 3, menuitem );
+  buf[8] = ':';
+  Display::itoa( buf + 10, 4, sw );
+  buf[0x0d] = (sw >= DAY_SW_MAX) ? '+' : ' ';
+  memcpy_P( buf + 0x0e, PSTR( "mal" ), 3 );
+  memcpy_P( buf + 0x12, PSTR( "ein:     " ), 9 );
+  Display::dhms( buf + 0x1b, minutes * 60UL );
 
+  buf[   0] = '|';
   buf[0x11] = '|';
   buf[0x22] = '|';
   buf[0x23] = 0;
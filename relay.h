@@ -7,12 +7,24 @@
 class Relay
 {
   private:
+    enum {
+      HOURS        = 24
+     ,DAYS         = 30      // ring of days in EEPROM (one more slot for end mark)
+     ,DAY_MIN_MAX  = 0x7fe   // packed day: minutes on in bits 0..10
+     ,DAY_SW_SHIFT = 11      //             switched on in bits 11..15
+     ,DAY_SW_MAX   = 31      //             (31: 31 or more)
+     ,DAY_END      = 0xffff  // end mark (never used minutes)
+    };
+
     byte      pin;
     byte      infonum; // num to use, when calling display->info()
+    byte      evSwitch; // Journal::EV, when switched on/off
+    byte      evMode;   // Journal::EV, when switch mode changed
     byte      on;      // 1=on 0=off
     byte      autoon;  // mode, if automatic mode is active
     byte      swmode;  // switch mode (SW_ON, SW_OFF, SW_AUTO, SW_TEMP)
     byte      prev;    // previous mode (SW_ON, SW_OFF, SW_AUTO)
+    byte      gen;     // generation: incremented on change of backup values
     short     timeout; // timeout value in minutes, when temporary switching on
     Ctrl    * ctrl;    // we need to know dusk and dawn time to collect total running time
 
@@ -23,32 +35,57 @@ class Relay
     unsigned long todayOn;    // total millis(), we run from refSec (excl. running())
     unsigned long totalOn;    // total secs running until yesterday (excl. running()+todayOn())
     unsigned long refSec;     // either dusk or dawn, when todayOn time starts
-    unsigned long secEnter;   // ctrl->sec, when we did enter the menu item "adjust timeout"
+
+    byte      hourMin[HOURS];  // minutes on per hour of day (aged 3/4 per day)
+    byte      onSecs;   // secs on not yet counted in hourMin
+    byte      switches; // switched on today
+    byte      dayHead;  // slot of next day in ring
+    int       eeDays;   // EEPROM address of ring of days
 
     void      turn( byte on ); // really turn on/off
+    void      saveDay(void);   // today to ring of days
 
   public:
-    Relay( byte pin );
-    void    init(void); // init PIN mode and switch off
-    void    setup( Ctrl * ctrl, byte infonum );
+    enum PARAM {   // settings to get/set
+      PAR_TIMEOUT = 0  // minutes "temporary on": TIMEOUT_MIN..TIMEOUT_MAX
+    };
+    enum LIMIT {
+      TIMEOUT_MIN = 1
+     ,TIMEOUT_MAX = 360  // 6h
+    };
+
+    Relay();
+    void    init( byte pin );  // init PIN mode and switch off
+    void    setup( Ctrl * ctrl, byte infonum, byte evSwitch, byte evMode, int eeDays );  // see circuit.h
     void    secLoop(void);
 
     unsigned long pausing();  // millis idle (0, when on)
     unsigned long running();  // millis on (0, when off)
     unsigned long before();   // millis on today before last switch
-    unsigned long today();    // total seconds running today (pump: since dawn / lamp: since dusk)
+    unsigned long today();    // total seconds running today (since dawn or dusk: Circuit::REF)
     unsigned long total();    // total seconds running since boot up
 
-    void    night( byte isNight );  // currently becoming night or day
+    void    newDay(void);           // dawn or dusk (Circuit::REF): today() to ring of days
 
     void    swMode( byte swmode );  // manual switching on/off/auto
     void    autoOn( byte autoon );  // automatic switching on/off
     byte    isOn() { return on; };  // fast detect running or not
+    byte    mode() { return swmode; };  // switch mode (Switch::MODE)
+    byte    num()  { return infonum; }; // Display::NUM
+    byte    generation(void);       // changes, when backup() would store other values
+    byte    hour( byte h ) { return hourMin[h]; };  // minutes on in hour h after midnight (aged)
+    boolean day( byte idx, word & minutes, byte & sw );  // idx 0: last day / false: no more
+
+    long    get( byte par );
+    boolean set( byte par, long val );  // false: out of range
 
+    enum { BACKUP_LEN = 12 + HOURS };  // bytes written by backup()
     int     backup( int addr );     // in: start address behind length / return: end address + 1
     void    restore( int addr, uint8_t len );
+    uint8_t * counters( uint8_t * buf );  // serialize totalOn/todayOn (as backup) / return: buf end
 
-    char  * show( char * buf, byte menuitem, byte init, const char * name );
+    char  * show( char * buf, byte menuitem, const char * name );  // name in flash
+    char  * showDay( char * buf, byte menuitem );  // item 1: last day (ring of days)
 };
 
 #endif
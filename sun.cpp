@@ -0,0 +1,67 @@
+#include "sun.h"
+
+static int16_t const sineTable[] PROGMEM =  // quarter wave: sin( i * 90 deg / 64 )
+{
+      0,   804,  1608,  2410,  3212,  4011,  4808,  5602,
+   6393,  7179,  7962,  8739,  9512, 10278, 11039, 11793,
+  12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+  18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+  23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+  27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+  30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+  32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+  32767
+};
+
+int16_t Sun::sin16( word angle )
+{
+  word x = angle & 0x3fff;  // within quadrant
+  if (angle & 0x4000)
+    x = 0x4000 - x;         // 2nd and 4th quadrant: falling
+
+  byte const i = x >> 8;
+  int16_t v = pgm_read_word( & sineTable[i] );
+  if (i < 64) {
+    int16_t const next = pgm_read_word( & sineTable[i + 1] );
+    v += ((long) (next - v) * (x & 0xff)) >> 8;  // linear interpolation
+  }
+  return (angle & 0x8000) ? -v : v;
+}
+
+int16_t Sun::cos16( word angle )
+{
+  return sin16( angle + 0x4000 );
+}
+
+word Sun::acos16( int16_t val )
+{
+  word lo = 0;       // cos( lo ) >  val
+  word hi = 0x8000;  // cos( hi ) <= val
+  while ((hi - lo) > 1) {
+    word const mid = (lo + hi) >> 1;
+    if (cos16( mid ) > val)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return hi;
+}
+
+unsigned long Sun::dayLight( int lat, word day )
+{
+  word const phi   = ((long) lat * 1165) >> 6;   // 1/10 deg -> binary angle (* 65536 / 3600)
+  word const year  = ((long) (day + 10) << 16) / DAYS;  // 0: winter solstice
+  int16_t const delta = -(((long) 4267 * cos16( year )) >> 15);  // declination: +/-23.44 deg
+
+  long const sinSin = ((long) sin16( phi ) * sin16( delta )) >> 15;
+  long       cosCos = ((long) cos16( phi ) * cos16( delta )) >> 15;
+  if (cosCos < 1)
+    cosCos = 1;      // pole: sun circles at constant height (cosH saturates below)
+  long cosH = ((-476L - sinSin) << 15) / cosCos;  // hour angle of sunrise: sin( -0.833 deg ) = -476
+  if (cosH > 32767)
+    cosH = 32767;    // polar night
+  else if (cosH < -32767)
+    cosH = -32767;   // midnight sun
+
+  return ((unsigned long) acos16( cosH ) * 675) >> 8;  // 2 * hour angle: 0x8000 -> 86400 secs
+}
@@ -0,0 +1,26 @@
+#ifndef Sun_h
+#define Sun_h
+
+#include <Arduino.h>
+
+// astronomical sunrise/sunset model in fixed point (no float):
+// length of day light from latitude and day of year
+// (declination by cosine approximation, sun's upper limb incl. refraction at -0.833 deg)
+//
+// angles are binary: 0x10000 = 360 deg, sine/cosine values 1.15 fixed point
+
+class Sun
+{
+  private:
+    static int16_t sin16( word angle );
+    static int16_t cos16( word angle );
+    static word    acos16( int16_t val );  // return: 0..0x8000
+
+  public:
+    enum {
+      DAYS = 365  // days per year (model error of leap years: less than a day)
+    };
+    static unsigned long dayLight( int lat, word day );  // lat: 1/10 deg (north > 0) / day: 1..DAYS / return: secs sunrise..sunset
+};
+
+#endif
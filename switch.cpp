@@ -2,9 +2,8 @@
 #include "switch.h"
 #include "display.h"
 
-Switch::Switch( byte pinArg )
-  : pin(        pinArg )
-  , chatter(         0 )
+Switch::Switch()
+  : chatter(         0 )
   , phyStatus(       0 )
   , clnStatus(       0 )
   , logStatus(    AUTO )  // start in automatic mode
@@ -16,34 +15,23 @@ Switch::Switch( byte pinArg )
 {
 }
 
-void Switch::init(void) // init PIN mode and switch off
+void Switch::init( byte pinArg ) // init PIN mode and switch off
 {
+  pin = pinArg;
   pinMode( pin, INPUT );      // sets the digital pin as input
 }
 
-void Switch::setup( Ctrl * ctrlArg, byte infonumArg )
+void Switch::setup( Ctrl * ctrlArg, Switch * otherArg, short keyminArg, short keymaxArg )
 {
-  ctrl    = ctrlArg;
-  infonum = infonumArg;
-
-  switch (infonum)
-  {
-    case Display::NUM_PUMP:
-      other = ctrl->lampSwitch;
+  ctrl  = ctrlArg;
+  other = otherArg;
 #ifdef KEYPAD
-      keymin =   0;
-      keymax =  66;
-#endif
-      break;
-
-    case Display::NUM_LAMP:
-      other = ctrl->pumpSwitch;
-#ifdef KEYPAD
-      keymin = 389;
-      keymax = 596;
+  keymin = keyminArg;
+  keymax = keymaxArg;
+#else
+  (void) keyminArg;
+  (void) keymaxArg;
 #endif
-      break;
-  }
 }
 
 byte Switch::loop()
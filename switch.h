@@ -33,7 +33,6 @@ class Switch
     };
 
     byte      pin;         // pin to look for
-    byte      infonum;     // num to use, when calling display->info()
     byte      chatter;     // chatter detect
     byte      phyStatus;   // physical status (even chatter)
     byte      clnStatus;   // clean status (chatter purged)
@@ -50,9 +49,9 @@ class Switch
 #endif
 
   public:
-    Switch( byte pin );
-    void    init(void);                      // init PIN mode
-    void    setup( Ctrl * ctrl, byte num );  // num is Display::NUM_... to set relay and other
+    Switch();
+    void    init( byte pin );  // init PIN mode
+    void    setup( Ctrl * ctrl, Switch * other, short keymin, short keymax );  // see circuit.h (keymin/max: KEYPAD)
     byte    loop(void);
 
     boolean idle(void);        // return false, when pressed or chatter detected (= "not idle")
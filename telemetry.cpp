@@ -0,0 +1,115 @@
+#include <util/crc16.h>  // _crc_xmodem_update()
+
+#include "telemetry.h"
+#include "relay.h"
+#include "circuit.h"  // Circuit::PUMP, Circuit::LAMP
+#include "lumi.h"
+#include "temp.h"
+#include "log.h"
+
+Telemetry::Telemetry()
+  : seq( 0 )
+  , due( 0 )
+  , pos( 0 )
+  , len( 0 )
+{
+}
+
+void Telemetry::setup( Ctrl * ctrlArg )
+{
+  ctrl = ctrlArg;
+}
+
+void Telemetry::secLoop(void)
+{
+  if (! (ctrl->sec % PERIOD))
+    due = 1;
+}
+
+void Telemetry::loop(void)
+{
+  if (pos == len) {  // idle
+    if (due)
+      status();
+#ifdef DEBUG
+    else {
+      byte const n = Log::get( frame + 2 );
+      if (! n)
+        return;
+      frame[1] = REC_LOG;
+      seal( frame + 2 + n );
+    }
+#else
+    else
+      return;
+#endif
+  }
+
+  byte n = Serial.availableForWrite();  // bytes we can write without blocking
+  while (n-- && (pos != len))
+    Serial.write( frame[pos++] );
+}
+
+void Telemetry::status(void)
+{
+  due = 0;
+
+  uint8_t * cp = frame + 1;
+  *cp++ = REC_STATUS;
+  *cp++ = seq++;
+  cp = Ctrl::put( cp, ctrl->sec );
+  for (byte s = 0; s < Temp::SENSOR_COUNT; ++s) {
+    int16_t const raw = ctrl->temp->raw( s ).raw();
+    memcpy( cp, & raw, 2 );
+    cp += 2;
+  }
+  for (byte s = 0; s < Temp::SENSOR_COUNT; ++s) {
+    int16_t const avg = ctrl->temp->avg( s ).raw();
+    memcpy( cp, & avg, 2 );
+    cp += 2;
+  }
+  *cp++ = ctrl->temp->sensorsOk();
+  *cp++ = ctrl->temp->result();
+  cp = relay( cp, & ctrl->relays[Circuit::PUMP] );
+  cp = relay( cp, & ctrl->relays[Circuit::LAMP] );
+  word const lum = ctrl->lumi->lum();
+  memcpy( cp, & lum, 2 );
+  cp += 2;
+  *cp++ = ctrl->lumi->state();
+  word const ram[] = { Ctrl::ramFree(), Ctrl::ramHeap(), Ctrl::ramGlobals() };
+  memcpy( cp, ram, sizeof(ram) );
+  cp += sizeof(ram);
+
+  seal( cp );
+}
+
+uint8_t * Telemetry::relay( uint8_t * cp, Relay * relay )
+{
+  *cp++ = relay->isOn() | (relay->mode() << 4);
+  cp = Ctrl::put( cp, relay->today() );
+  return Ctrl::put( cp, relay->total() );
+}
+
+void Telemetry::seal( uint8_t * end )
+{
+  word crc = 0;
+  for (uint8_t * cp = frame + 1; cp < end; ++cp)
+    crc = _crc_xmodem_update( crc, *cp );
+  *end++ = (uint8_t) crc;
+  *end++ = (uint8_t) (crc >> 8);
+
+  // COBS: each zero is replaced by the distance to the next one
+  // (frame[0] and the final delimiter count as zero; records are shorter than 254 bytes)
+  byte code = 0;  // index of last zero
+  byte i;
+  for (i = 1; frame + i < end; ++i)
+    if (! frame[i]) {
+      frame[code] = i - code;
+      code = i;
+    }
+  frame[code] = i - code;
+  frame[i++]  = 0;
+
+  len = i;
+  pos = 0;
+}
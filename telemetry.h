@@ -0,0 +1,67 @@
+#ifndef Telemetry_h
+#define Telemetry_h
+
+#include <Arduino.h>
+#include "ctrl.h"
+
+// binary status records on serial output (9600 baud), when TELEMETRY is defined in ctrl.h
+// (host decoder: tools/telemetry.py csv)
+//
+// frame:  COBS( record, crc ) 0x00
+//         crc: CRC-16/XMODEM (poly 0x1021, init 0) of record, low byte first
+//
+// record REC_STATUS (little endian, every PERIOD seconds):
+//    0  type       u8   REC_STATUS
+//    1  seq        u8   incremented per record (detects lost frames)
+//    2  sec        u32  Ctrl::sec (seconds since boot up)
+//    6  raw[5]     i16  temperature in 1/16 C: sol, pool, ins, air, box (0x7fff: not yet read)
+//   16  avg[5]     i16  low pass filtered temperature, same order
+//   26  devok      u8   bit mask of sensors read in current cycle (same order)
+//   27  result     u8   last result of Temp::finalize() (see Temp::RESULT)
+//   28  pump       u8   bit 0: on / bits 4..7: switch mode (see Switch::MODE)
+//   29  pumpToday  u32  seconds on today
+//   33  pumpTotal  u32  seconds on since boot up
+//   37  lamp            9 bytes as pump
+//   46  lum        u16  last read luminance value
+//   48  lumi       u8   Lumi status (bit 0: night / bit 1: detecting dusk or dawn)
+//   49  ramFree    u16  min. free bytes between heap and stack since boot up
+//   51  ramHeap    u16  bytes allocated on heap
+//   53  ramGlobals u16  bytes of global variables
+//
+// record REC_LOG: debug message (DEBUG only, see log.h)
+
+class Telemetry
+{
+  public:
+    enum {
+      REC_STATUS = 1
+     ,REC_LOG
+    };
+
+  private:
+    enum {
+      PERIOD     = 60   // seconds between status records
+     ,STATUS_LEN = 55   // length of REC_STATUS
+     ,FRAME_LEN  = STATUS_LEN + 2 + 2  // + crc + COBS code + delimiter
+    };
+
+    byte      seq;     // sequence number of next record
+    byte      due;     // status record to send
+    byte      pos;     // next frame byte to pass to UART
+    byte      len;     // length of frame (pos == len: idle)
+    uint8_t   frame[FRAME_LEN];  // record is built at frame + 1 and encoded in place
+    Ctrl    * ctrl;
+
+    void      status(void);  // build status record
+    uint8_t * relay( uint8_t * cp, Relay * relay );  // serialize state and runtimes
+    void      seal( uint8_t * end );  // append crc and encode frame in place
+
+  public:
+    Telemetry();
+    void    setup( Ctrl * ctrl );
+    void    secLoop(void);  // every PERIOD seconds: status record due
+    void    loop(void);     // pass frame bytes to UART, as long as its TX buffer has space
+                            // (when idle: status record, when due, otherwise next log message)
+};
+
+#endif
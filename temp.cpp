@@ -3,8 +3,14 @@
 #include "display.h"
 #include "relay.h"
 #include "switch.h"
+#include "circuit.h"    // Circuit::SRC_TEMP
+#include "events.h"     // autoOn and display info are posted (not to delay OneWire steps)
 #include "lumi.h"
 #include "temp.h"
+#include "log.h"        // debug messages
+
+enum { LEAD = Circuits<>::first( Circuit::SRC_TEMP ) };  // relay, whose running/pausing times decide (filter pump)
+static_assert( LEAD < CIRCUITS, "no circuit switched by Temp (circuitTable)" );
 
 byte const atPool[] = { TempDevAddrPool };
 byte const atIns[]  = { TempDevAddrIns  };
@@ -13,17 +19,25 @@ byte const atAir[]  = { TempDevAddrAir  };
 byte const atBox[]  = { TempDevAddrBox  };
 
 
-const struct {
-  char const * name;
+static char const nameSol[]  PROGMEM = "Solar";
+static char const namePool[] PROGMEM = "Pool ";
+static char const nameIns[]  PROGMEM = "Ins  ";
+static char const nameAir[]  PROGMEM = "Air  ";
+static char const nameBox[]  PROGMEM = "Ctrl ";
+
+struct sensorCfg {
+  char const * name;  // in flash
   byte const * addr;
   byte         sensorNum;
   byte         displayNum;
+};
 
-} aTemp[] = { { "Solar" ,atSol  ,Temp::SENSOR_SOL  ,Display::NUM_SOL  }
-             ,{ "Pool " ,atPool ,Temp::SENSOR_POOL ,Display::NUM_POOL }
-             ,{ "Ins  " ,atIns  ,Temp::SENSOR_INS  ,Display::NUM_INS  }
-             ,{ "Air  " ,atAir  ,Temp::SENSOR_AIR  ,Display::NUM_AIR  }
-             ,{ "Ctrl " ,atBox  ,Temp::SENSOR_BOX  ,Display::NUM_BOX  }
+sensorCfg const aTemp[] PROGMEM =
+             { { nameSol  ,atSol  ,Temp::SENSOR_SOL  ,Display::NUM_SOL  }
+              ,{ namePool ,atPool ,Temp::SENSOR_POOL ,Display::NUM_POOL }
+              ,{ nameIns  ,atIns  ,Temp::SENSOR_INS  ,Display::NUM_INS  }
+              ,{ nameAir  ,atAir  ,Temp::SENSOR_AIR  ,Display::NUM_AIR  }
+              ,{ nameBox  ,atBox  ,Temp::SENSOR_BOX  ,Display::NUM_BOX  }
 };
 
 Temp::Temp()
@@ -31,12 +45,17 @@ Temp::Temp()
   , state(  0 )           // not conv -> do conv on 1st step
   , devok(  0 )           // no sensor yet read
   , autoon( 0 )           // yet not switched on
+  , gen(    0 )
+  , last(   NO_ACTION )
+  , histNext(  0 )
+  , histCount( 0 )
 
   , shiftPausing( 11 )
   , shiftB4Start( 17 )
   , shiftRunning( 15 )
   , shiftB4Stop(  16 )
-  , res( NO_ACTION )
+  , diff(      Temperature::celsius( 0 ) )
+  , threshold( Temperature::celsius( 0 ) )
 {
 }
 
@@ -48,16 +67,18 @@ void Temp::setup( Ctrl * ctrlArg, OneWire * owArg )
   usecNextaction = usecNextstart = micros() + (2 _M);  // give rest of system 2 more secs to startup
 
   for (byte i = 0; i < NELEMENTS(aTemp); ++i) {
-    mem * const m = & t[aTemp[i].sensorNum];
+    sensorCfg cfg;
+    memcpy_P( & cfg, & aTemp[i], sizeof(cfg) );
+    mem * const m = & t[cfg.sensorNum];
 
-    displayNum[aTemp[i].sensorNum] = aTemp[i].displayNum;
-    sensorNum[aTemp[i].displayNum] = aTemp[i].sensorNum;
+    displayNum[cfg.sensorNum] = cfg.displayNum;
+    sensorNum[cfg.displayNum] = cfg.sensorNum;
 
-    m->name = aTemp[i].name;
-    m->addr = aTemp[i].addr;
+    m->name = cfg.name;
+    m->addr = cfg.addr;
     m->conv = 0; // overwritten in check(), when addr is valid
     m->res  = 0; // set to correct value, on 1st successful read
-    m->min[0] = 0x7fff;  // invalid value to set all min/max on very first read
+    m->min[0] = Temperature();  // invalid value to set all min/max on very first read
     check( m );
   }
 
@@ -66,72 +87,26 @@ void Temp::setup( Ctrl * ctrlArg, OneWire * owArg )
 
 void Temp::loop(void)
 {
-#ifdef TEMP_DEBUG
-  if (res != NO_ACTION) {
-    switch (res)
-    {
-      case NOT_COMPLETE:
-        Serial.println( "    no switch, when any data invalid" );
-        break;
-      case STILL_NIGHT:
-        Serial.println( "    still night" );
-        break;
-      case CAUSE_NIGHT:
-        Serial.println( "    switched off cause dusk" );
-        break;
-
-      case STAY_TIME:
-      case STAY_TEMP:
-      case STAY_COLD:
-      case CAUSE_TIME:
-      case CAUSE_TEMP:
-        switch (res) {
-          case CAUSE_TIME:
-          case CAUSE_TEMP: Serial.print( "        switched " ); break;
-          default:         Serial.print( "    not switched " ); break;
-        }
-        switch (res) {
-          case STAY_TIME:
-          case CAUSE_TIME: Serial.print( "cause time  " ); break;
-          default:         Serial.print( "cause temp. " ); break;
-        }
-        Serial.print( before / 60000.0 ); // minutes as float
-        Serial.print( " / " );
-        Serial.print( time / 60000.0 ); // minutes as float
-        Serial.print( " / " );
-        Serial.print( threshold / 16.0 );  // raw -> C
-        Serial.print( " / " );
-        Serial.print( diff / 16.0 );  // raw -> Kelvin
-        Serial.println( " (before/time/thres/diff)" );
-        break;
-    }
-    res = NO_ACTION;
-  }
-#else
-  res = NO_ACTION;
-#endif
-
   long delta = micros() - usecNextaction;
   if (delta < 0)
     return;
 
-  char const * const err = act();
+  byte const err = act();
   if (err) { // error happened
     // not finalize
-    restart();
 #ifdef DEBUG
-    Serial.print("error on device ");
-    Serial.print(t[index].name);
-    Serial.print(": ");
-    Serial.println(err);
+    byte const args[] = { index, err };
+    Log::put( Log::MSG_TEMP_ERROR, args, sizeof(args) );
 #endif
+    restart();
     return;
   }
 }
 
 void Temp::restart(void)
 {
-  boolean fastread = ctrl->pumpRelay->isOn();
+  Relay & relay = ctrl->relays[LEAD];
+  boolean fastread = (relay.mode() == Switch::AUTO) ? autoon : relay.isOn();  // autoOn may be pending
   if (fastread)
     usecNextstart += 7500 _k;  // run every 7.5 secs (1/8 of one minute)
   else
@@ -174,8 +149,8 @@ void Temp::check( mem * m )
 {
   if (OneWire::crc8(m->addr, 7) != m->addr[7]) {
 #ifdef DEBUG
-    Serial.print(m->name);
-    Serial.println("  CRC of address is not valid!");
+    byte const sensor = m - t;
+    Log::put( Log::MSG_TEMP_ADDR, & sensor, 1 );
 #endif
     return;
   }
@@ -188,8 +163,10 @@ void Temp::check( mem * m )
       break;
     default:
 #ifdef DEBUG
-      Serial.print(m->name);
-      Serial.println("  Device is not a DS18x20 family device.");
+      {
+        byte const args[] = { (byte) (m - t), m->addr[0] };
+        Log::put( Log::MSG_TEMP_FAMILY, args, sizeof(args) );
+      }
 #endif
       return;
   }
@@ -197,12 +174,13 @@ void Temp::check( mem * m )
   m->conv = 750000; // addr is ok ==> let know, that we can read temperature
 }
 
-char const * Temp::act(void)
+byte Temp::act(void)
 {
+  Ctrl::crumb = Ctrl::CRUMB_TEMP;
   if (index >= SENSOR_COUNT)
-    return "no valid device in list";
+    return ERR_NO_SENSOR;
 
-  char const * ret = 0;
+  byte ret = ERR_NONE;
   switch (state & 1)
   {
     case 0:
@@ -212,30 +190,47 @@ char const * Temp::act(void)
     case 1:
       ret = data();
       if (ret) {
-        DEBUG_EXPR( Serial.print("error on device ") )
-        DEBUG_EXPR( Serial.print(t[index].name) )
-        DEBUG_EXPR( Serial.print(": ") )
-        DEBUG_EXPR( Serial.println(ret) )
-        ret = 0;
+#ifdef DEBUG
+        byte const args[] = { index, ret };
+        Log::put( Log::MSG_TEMP_ERROR, args, sizeof(args) );
+#endif
+        ret = ERR_NONE;
       }
 
       if (next()) {
         ret = conv();
         break;
       }
-      res = finalize();
+      {
+        byte const was = autoon;
+        last = finalize();
+        if (autoon != was)
+          remember();
+      }
+#ifdef TEMP_DEBUG
+      {
+        struct {
+          byte          result;
+          unsigned long before;
+          unsigned long time;
+          int16_t       threshold;
+          int16_t       diff;
+        } const args = { last, before, time, threshold.raw(), diff.raw() };
+        Log::put( Log::MSG_TEMP_RESULT, & args, sizeof(args) );
+      }
+#endif
       restart();
       break;
   }
   return ret;
 }
 
-char const * Temp::conv(void)
+byte Temp::conv(void)
 {
   devok &= ~(1 << index);
 
   if (! ow->reset())
-    return "no device detected";
+    return ERR_NO_DEVICE;
 
   mem * const m = & t[index];
 
@@ -244,13 +239,13 @@ char const * Temp::conv(void)
 
   usecNextaction = micros() + m->conv + 100000; // add safety
   state |= 1; // "conv running"
-  return 0;
+  return ERR_NONE;
 }
 
-char const * Temp::data()
+byte Temp::data()
 {
   if (! ow->reset())
-    return "no device detected";
+    return ERR_NO_DEVICE;
 
   mem * const m = & t[index];
 
@@ -263,32 +258,27 @@ char const * Temp::data()
     buf[i] = ow->read();
 
   if (OneWire::crc8( buf, 8 ) != buf[8])
-    return "data CRC invalid";
+    return ERR_CRC;
 
   if (((buf[0] == 0x50) && (buf[1] == 0x05)) ||
       ((buf[0] == 0xff) && (buf[1] == 0x07)) ||
       ((! buf[0]) && (! buf[1]) && (! buf[8]))) {
 #ifdef DEBUG
-    Serial.print("  strange data for device ");
-    Serial.print(m->name);
-    Serial.print(":");
-    for (i = 0; i < 9; i++) {
-      Serial.print(" ");
-      if (buf[i] < 0x10) Serial.print("0");
-      Serial.print(buf[i],HEX);
-    }
-    Serial.println();
+    byte args[10];
+    args[0] = index;
+    memcpy( args + 1, buf, 9 );
+    Log::put( Log::MSG_TEMP_DATA, args, sizeof(args) );
 #endif
-    return "strange data";
+    return ERR_DATA;
   }
 #if 0
   else {
-    Serial.print("          data for device ");
-    Serial.print(m->name);
-    Serial.print(":");
+    Serial.print( F( "          data for device " ) );
+    Serial.print( (__FlashStringHelper const *) m->name );
+    Serial.print( F( ":" ) );
     for (i = 0; i < 9; i++) {
-      Serial.print(" ");
-      if (buf[i] < 0x10) Serial.print("0");
+      Serial.print( F( " " ) );
+      if (buf[i] < 0x10) Serial.print( F( "0" ) );
       Serial.print(buf[i],HEX);
     }
     Serial.println();
@@ -319,41 +309,47 @@ char const * Temp::data()
     }
 
     raw &= m->res; // at lower res, the low bits are undefined, so let's zero them
-    m->temp = raw;
+    m->temp = Temperature::fromRaw( raw );
     // init sum:
     m->sum = raw << 3;
-    m->avg = raw;
+    m->avg = m->temp;
 
-    if (m->min[0] == 0x7fff)
+    if (! m->min[0].valid()) {
       for (byte x = 0; x < PERIOD_COUNT; ++x)
-        m->min[x] = m->max[x] = raw;
+        m->min[x] = m->max[x] = m->temp;
+      ++gen;  // new sensor in backup
+    }
   } else {
     raw &= m->res; // at lower res, the low bits are undefined, so let's zero them
-    m->temp = raw;
+    m->temp = Temperature::fromRaw( raw );
     // low pass filter:
-    m->sum += (raw - m->avg);    // 1/8 of delta added to avg
-    m->avg = (m->sum + 4) >> 3;  // round sum / 8
+    m->sum += (raw - m->avg.raw());                   // 1/8 of delta added to avg
+    m->avg = Temperature::fromRaw( (m->sum + 4) >> 3 );  // round sum / 8
 
-    if (m->min[0] > m->avg)
+    if (m->min[0] > m->avg) {
         m->min[0] = m->avg;
-    else
-    if (m->max[0] < m->avg)
+        ++gen;
+    } else
+    if (m->max[0] < m->avg) {
         m->max[0] = m->avg;
+        ++gen;
+    }
   }
 
   // note: m->temp is unchanged, if read fails
 
   devok |= (1 << index);
-  ctrl->display->info( displayNum[index], tocelsius(raw) );
+  ctrl->events->post( Events::EV_INFO, displayNum[index], m->temp.toCelsius() );
   return 0;
 }
 
 void Temp::night( byte isNight )  // currently becoming night or day
 {
   if (isNight) {                  // -> dusk
-    ctrl->pumpRelay->autoOn( autoon = 0 );  // don't run at night
+    ctrl->events->post( Events::EV_AUTO, Circuit::SRC_TEMP, autoon = 0 );  // don't run at night
   }
   else {
+    ++gen;
     int const day = ((ctrl->sec + ctrl->totalOn) / 86400L + 1);
     for (byte d = 0; d < SENSOR_COUNT; ++d) {
       mem * const m = & t[d];
@@ -391,17 +387,16 @@ byte Temp::finalize(void)
 {
   if (ctrl->lumi->night()) {
     if (autoon) {
-      ctrl->pumpRelay->autoOn( autoon = 0 );  // don't run at night
-      DEBUG_EXPR( Serial.println( "    stay off at night" ) )
+      ctrl->events->post( Events::EV_AUTO, Circuit::SRC_TEMP, autoon = 0 );  // don't run at night
       return CAUSE_NIGHT;
     }
     return STILL_NIGHT;
   }
 
-  time      = ctrl->pumpRelay->running();
-  before    = ctrl->pumpRelay->before();
+  time      = ctrl->relays[LEAD].running();
+  before    = ctrl->relays[LEAD].before();
   diff      = t[SENSOR_SOL].temp - t[SENSOR_POOL].temp;
-  threshold = 0;  // to indicate "temperature not to check"
+  threshold = Temperature::celsius( 0 );  // to indicate "temperature not to check"
 
   if (time) { // running
 
@@ -412,7 +407,7 @@ byte Temp::finalize(void)
 
     if (time < (60 _k)) { // running less than 1 minute:
       if (! autoon) // manual switched on
-        ctrl->pumpRelay->autoOn( autoon = 1 );
+        ctrl->events->post( Events::EV_AUTO, Circuit::SRC_TEMP, autoon = 1 );
 
       // not to switch off, since running less than 1 minute
       return STAY_TIME;
@@ -420,7 +415,7 @@ byte Temp::finalize(void)
 
     if (time >= (2 * 60 * 60 _k)) { // running 2 hours or more
       if (autoon)
-        ctrl->pumpRelay->autoOn( autoon = 0 );  // maximum running time reached
+        ctrl->events->post( Events::EV_AUTO, Circuit::SRC_TEMP, autoon = 0 );  // maximum running time reached
 
       // to switch off due to running more than 2 hours
       return CAUSE_TIME;
@@ -429,17 +424,18 @@ byte Temp::finalize(void)
     // the longer we run, the higher delta is needed to stay running
     // previous run counts half
 
-    threshold = (short) (((time >> shiftRunning) + (before >> shiftB4Stop)) & 0x7fff);
+    threshold = Temperature::fromRaw( time   >> shiftRunning )
+              + Temperature::fromRaw( before >> shiftB4Stop );
 
     if (diff <= threshold) { // switch off when diff decreases
       if (autoon)
-        ctrl->pumpRelay->autoOn( autoon = 0 ); // turn off, when "normal" difference
+        ctrl->events->post( Events::EV_AUTO, Circuit::SRC_TEMP, autoon = 0 ); // turn off, when "normal" difference
 
       return CAUSE_TEMP;
     }
 
     if (! autoon) // manual switched on
-      ctrl->pumpRelay->autoOn( autoon = 1 );
+      ctrl->events->post( Events::EV_AUTO, Circuit::SRC_TEMP, autoon = 1 );
 
     return STAY_TEMP;
   }
@@ -452,25 +448,25 @@ byte Temp::finalize(void)
     return NOT_COMPLETE;  // exact values unknown -> don't switch on when we can't trust
   }
 
-  time = ctrl->pumpRelay->pausing();
+  time = ctrl->relays[LEAD].pausing();
 
   if (time < (1 * 60 _k)) { // pausing less than 1 minute
     if (autoon) // manual switched off
-      ctrl->pumpRelay->autoOn( autoon = 0 );
+      ctrl->events->post( Events::EV_AUTO, Circuit::SRC_TEMP, autoon = 0 );
 
     // not to switch on, since pausing less than 1 minute
     return STAY_TIME;
   }
   if (time >= (2 * 60 * 60 _k)) {
-    if (diff >= 0) {
+    if (diff >= Temperature::celsius( 0 )) {
       if (! autoon)
-        ctrl->pumpRelay->autoOn( autoon = 1 );  // maximum idle time reached
+        ctrl->events->post( Events::EV_AUTO, Circuit::SRC_TEMP, autoon = 1 );  // maximum idle time reached
 
       // switch on, due to pausing more than 2 houre and diff >= 0
       return CAUSE_TIME;
     }
     if (autoon)
-      ctrl->pumpRelay->autoOn( autoon = 0 );
+      ctrl->events->post( Events::EV_AUTO, Circuit::SRC_TEMP, autoon = 0 );
 
     // not to switch on, even so pausing more than 2 houre but diff < 0
     return STAY_COLD; // colder than pool: not run
@@ -479,26 +475,47 @@ byte Temp::finalize(void)
   // the longer we paused, the lower delta is needed to switch on
   // but the longer we run before, the higher delta is needed to switch on
 
-  threshold = (0x7fff / ((short) ((time >> shiftPausing) & 0x7fff))) + (before >> shiftB4Start);
+  unsigned long const paused = time >> shiftPausing;  // >= 1, since time >= 1 min and shift <= 15
+  threshold = Temperature::fromRaw( 0x7fffU / (word) ((paused < 0x7fff) ? paused : 0x7fff) )
+            + Temperature::fromRaw( before >> shiftB4Start );
 
   if (diff >= threshold) {
     if (! autoon)
-      ctrl->pumpRelay->autoOn( autoon = 1 );  // turn on, when "big" difference
+      ctrl->events->post( Events::EV_AUTO, Circuit::SRC_TEMP, autoon = 1 );  // turn on, when "big" difference
     return CAUSE_TEMP;
   }
 
   if (autoon)
-    ctrl->pumpRelay->autoOn( autoon = 0 );
+    ctrl->events->post( Events::EV_AUTO, Circuit::SRC_TEMP, autoon = 0 );
 
   return STAY_TEMP;
 }
 
-int8_t Temp::tocelsius(short raw)
+static int8_t quarter( Temperature t )  // 1/16 -> 1/4 K, saturated to int8_t
 {
-  if (raw >= 0x0800)  // 128 C and more...
-    return 0x7f;      // will use 127 C
+  int16_t const q = t.raw() >> 2;
+  return (q > 127) ? 127 : (q < -128) ? -128 : q;
+}
+
+void Temp::remember(void)
+{
+  decision & d = hist[histNext];
+  d.min   = ctrl->sec / 60;
+  d.cause = last | (autoon ? DEC_ON : 0);
+  d.diff  = quarter( diff );
+  d.thres = quarter( threshold );
+
+  histNext = (histNext + 1) % HIST_LEN;
+  if (histCount < HIST_LEN)
+    ++histCount;
+}
 
-  return ((raw + 8) / 16);  // we don't expect temperatures below -128 C
+boolean Temp::history( byte idx, decision & d )
+{
+  if (idx >= histCount)
+    return false;
+  d = hist[(histNext + HIST_LEN - 1 - idx) % HIST_LEN];
+  return true;
 }
 
 int Temp::backup( int addr )        // in: start address / return: end address + 1
@@ -508,13 +525,12 @@ int Temp::backup( int addr )        // in: start address / return: end address +
   for (byte index = 0; index < SENSOR_COUNT; ++index)
   {
     mem * const m = & t[index];
-    // even (int16_t) m->min[0] == (int16_t) 0x7fff) leads to compiler warning
-    if (m->min[0] == 0x7fff)
+    if (! m->min[0].valid())
       continue;  // not any valid value until now
 
-    addr = Ctrl::save( addr, (uint8_t)     m->name[0] );
-    addr = Ctrl::save( addr, (uint8_t *) & m->min[0], PERIOD_COUNT * sizeof(uint16_t) );
-    addr = Ctrl::save( addr, (uint8_t *) & m->max[0], PERIOD_COUNT * sizeof(uint16_t) );
+    addr = Ctrl::save( addr, (uint8_t)     pgm_read_byte( m->name ) );
+    addr = Ctrl::save( addr, (uint8_t *) & m->min[0], PERIOD_COUNT * sizeof(Temperature) );
+    addr = Ctrl::save( addr, (uint8_t *) & m->max[0], PERIOD_COUNT * sizeof(Temperature) );
   }
 
   addr = Ctrl::save( addr, (uint8_t) '%' );  // -> settings
@@ -553,14 +569,14 @@ void Temp::restore( int addr, uint8_t len )
 
       for (byte i = 0; i < SENSOR_COUNT; ++i) {
         mem * const m = & t[i];
-        if (m->name[0] == x) {
+        if (pgm_read_byte( m->name ) == x) {
           Ctrl::readN( addr,                      (uint8_t *) & m->min[0], PERIOD_COUNT * 2 );
           Ctrl::readN( addr + (PERIOD_COUNT * 2), (uint8_t *) & m->max[0], PERIOD_COUNT * 2 );
 #if 0 // quick and dirty work around to fix min 0 values
           for (byte p = 0; p < PERIOD_COUNT; ++p) {
-            if (p && ! m->max[p])
+            if (p && ! m->max[p].raw())
               m->max[p] = m->max[p-1];
-            if (! m->min[p])
+            if (! m->min[p].raw())
               if (! p)
                 m->min[p] = m->max[p];
               else
@@ -576,12 +592,38 @@ void Temp::restore( int addr, uint8_t len )
   }
 }
 
-char * Temp::showThres( char * buf, byte menuitem, byte init )
+Temp::setting const Temp::settings[PAR_COUNT] PROGMEM =
+                   { { & Temp::shiftPausing,  6, 15, 1 }
+                    ,{ & Temp::shiftB4Start, 10, 19, 0 }
+                    ,{ & Temp::shiftRunning, 10, 19, 0 }
+                    ,{ & Temp::shiftB4Stop,  10, 19, 0 } };
+
+long Temp::get( byte par )
+{
+  setting set;
+  memcpy_P( & set, & settings[par], sizeof(set) );
+  byte const shift = this->*set.shift;
+  return set.invert ? (set.max - shift) : (shift - set.min);
+}
+
+boolean Temp::set( byte par, long val )
 {
-  static const char * settings[] = { "Pause (ein)" ,"Heute (ein)"
-                         ,"l" STR_AUML "uft (aus)" ,"Heute (aus)" };
+  setting set;
+  memcpy_P( & set, & settings[par], sizeof(set) );
+  if ((val < 0) || (val > (set.max - set.min)))
+    return false;
+
+  byte const shift = set.invert ? (set.max - val) : (set.min + val);
+  if (this->*set.shift != shift) {
+    this->*set.shift = shift;
+    ++gen;
+  }
+  return true;
+}
 
-  if (menuitem >= 10)
+char * Temp::showThres( char * buf, byte menuitem )
+{
+  if (menuitem > 1)
     return 0;
 
   memset( buf + 1, ' ', 33 );
@@ -590,49 +632,47 @@ char * Temp::showThres( char * buf, byte menuitem, byte init )
   buf[0x22] = '|';
   buf[0x23] = 0;
 
-  if (menuitem == 1) {
-    Display::dhms( buf + 1, (before + 500) / 1000 );
-    buf[6] = buf[7];
-    Display::dhms( buf + 7, (time + 500) / 1000 );
-    buf[12] = buf[13];
-    Display::kelvin( buf + 13, threshold );
-    Display::kelvin( buf + 0x1e, diff );
-    ctrl->display->restart();  // do not switch back to info from here
-    return buf;
-  }
+  Display::dhms( buf + 1, (before + 500) / 1000 );
+  buf[6] = buf[7];
+  Display::dhms( buf + 7, (time + 500) / 1000 );
+  buf[12] = buf[13];
+  threshold.print( buf + 13 );
+  diff.print( buf + 0x1e );
+  ctrl->display->restart();  // do not switch back to info from here
+  return buf;
+}
 
-  memcpy( buf + 1, "Einstellung   +1", 16 );
-  if (menuitem & 1)
-    buf[15] = '-';
-  memcpy( buf + 0x12, settings[(menuitem - 2) >> 1], 11 );
-  buf[0x1d] = ':';
-
-  if (init)
-    secEnter = ctrl->sec;
-  else if (ctrl->sec > (secEnter + 3)) {
-    switch (menuitem - 2) {
-      case 0: if (shiftPausing >  6) shiftPausing--; break;
-      case 1: if (shiftPausing < 15) shiftPausing++; break;
-      case 2: if (shiftB4Start < 19) shiftB4Start++; break;
-      case 3: if (shiftB4Start > 10) shiftB4Start--; break;
-      case 4: if (shiftRunning < 19) shiftRunning++; break;
-      case 5: if (shiftRunning > 10) shiftRunning--; break;
-      case 6: if (shiftB4Stop  < 19) shiftB4Stop++;  break;
-      case 7: if (shiftB4Stop  > 10) shiftB4Stop--;  break;
-    }
-  }
-  switch ((menuitem - 2) >> 1) {
-    case 0: Display::itoa( buf + 0x20, 3, 15 - shiftPausing ); break;
-    case 1: Display::itoa( buf + 0x20, 3, shiftB4Start - 10 ); break;
-    case 2: Display::itoa( buf + 0x20, 3, shiftRunning - 10 ); break;
-    case 3: Display::itoa( buf + 0x20, 3, shiftB4Stop  - 10 ); break;
-  }
+
+char * Temp::showHist( char * buf, byte menuitem )
+{
+  // |0123456789abcdef|
+  // |Temp. ein 12:34 m|  <- cause, switched on/off, age
+  // |Diff 2,5 Sw. 1,8|
+
+  static char const causes[] PROGMEM =  // 5 chars per RESULT
+    "-    Fehl.DatenNachtZeit Temp.kalt NachtZeit Temp.";
+
+  decision d;
+  if (! history( menuitem - 1, d ))
+    return 0;
+
+  memset( buf + 1, ' ', 33 );
+  buf[   0] = '|';
+  buf[0x11] = '|';
   buf[0x22] = '|';
+  buf[0x23] = 0;
+
+  memcpy_P( buf + 1, causes + 5 * (d.cause & ~DEC_ON), 5 );
+  memcpy_P( buf + 7, (d.cause & DEC_ON) ? PSTR( "ein" ) : PSTR( "aus" ), 3 );
+  Display::dhms( buf + 10, (word) ((word) (ctrl->sec / 60) - d.min) * 60L );
 
+  memcpy_P( buf + 0x12, PSTR( "Diff" ), 4 );
+  Temperature::fromRaw( d.diff * 4 ).print( buf + 0x16 );
+  memcpy_P( buf + 0x1a, PSTR( " Sw." ), 4 );
+  Temperature::fromRaw( d.thres * 4 ).print( buf + 0x1e );
   return buf;
 }
 
-
 char * Temp::showValue( char * buf, byte menuitem, byte displayNum )
 {
   if ((menuitem > 3) || (displayNum >= Display::NUM_TEMP))
@@ -653,7 +693,7 @@ char * Temp::showValue( char * buf, byte menuitem, byte displayNum )
 
   mem * const m = & t[sensorNum[displayNum]];
 
-  if (m->min[0] == 0x7fff)
+  if (! m->min[0].valid())
     return 0;  // keine Werte fuer diesen Sensor
 
   memset( buf + 1, ' ', 33 );
@@ -664,38 +704,38 @@ char * Temp::showValue( char * buf, byte menuitem, byte displayNum )
 
   switch (menuitem) {
     case 1:
-      memcpy( buf +  1, "jetzt:", 6 );
-      Display::kelvin( buf + 13, m->temp );
+      memcpy_P( buf +  1, PSTR( "jetzt:" ), 6 );
+      m->temp.print( buf + 13 );
 
-      memcpy( buf + 0x12, "Tag:", 4 );
-      Display::kelvin( buf + 0x18, m->min[PERIOD_DAY] );
-      memcpy( buf + 0x1c, "..", 2 );
-      Display::kelvin( buf + 0x1e, m->max[PERIOD_DAY] );
+      memcpy_P( buf + 0x12, PSTR( "Tag:" ), 4 );
+      m->min[PERIOD_DAY].print( buf + 0x18 );
+      memcpy_P( buf + 0x1c, PSTR( ".." ), 2 );
+      m->max[PERIOD_DAY].print( buf + 0x1e );
       ctrl->display->restart();
       break;
 
     case 2:
-      memcpy( buf +  1, "Wo.:", 4 );
-      Display::kelvin( buf +  7, m->min[PERIOD_WEEK] );
-      memcpy( buf + 11, "..", 2 );
-      Display::kelvin( buf + 13, m->max[PERIOD_WEEK] );
-
-      memcpy( buf + 0x12, "Mo.:", 4 );
-      Display::kelvin( buf + 0x18, m->min[PERIOD_MONTH] );
-      memcpy( buf + 0x1c, "..", 2 );
-      Display::kelvin( buf + 0x1e, m->max[PERIOD_MONTH] );
+      memcpy_P( buf +  1, PSTR( "Wo.:" ), 4 );
+      m->min[PERIOD_WEEK].print( buf +  7 );
+      memcpy_P( buf + 11, PSTR( ".." ), 2 );
+      m->max[PERIOD_WEEK].print( buf + 13 );
+
+      memcpy_P( buf + 0x12, PSTR( "Mo.:" ), 4 );
+      m->min[PERIOD_MONTH].print( buf + 0x18 );
+      memcpy_P( buf + 0x1c, PSTR( ".." ), 2 );
+      m->max[PERIOD_MONTH].print( buf + 0x1e );
       break;
 
     case 3:
-      memcpy( buf +  1, "Jahr:", 5 );
-      Display::kelvin( buf +  7, m->min[PERIOD_YEAR] );
-      memcpy( buf + 11, "..", 2 );
-      Display::kelvin( buf + 13, m->max[PERIOD_YEAR] );
-
-      memcpy( buf + 0x12, "ges.:", 5 );
-      Display::kelvin( buf + 0x18, m->min[PERIOD_OVERALL] );
-      memcpy( buf + 0x1c, "..", 2 );
-      Display::kelvin( buf + 0x1e, m->max[PERIOD_OVERALL] );
+      memcpy_P( buf +  1, PSTR( "Jahr:" ), 5 );
+      m->min[PERIOD_YEAR].print( buf +  7 );
+      memcpy_P( buf + 11, PSTR( ".." ), 2 );
+      m->max[PERIOD_YEAR].print( buf + 13 );
+
+      memcpy_P( buf + 0x12, PSTR( "ges.:" ), 5 );
+      m->min[PERIOD_OVERALL].print( buf + 0x18 );
+      memcpy_P( buf + 0x1c, PSTR( ".." ), 2 );
+      m->max[PERIOD_OVERALL].print( buf + 0x1e );
       break;
   }
   return buf;
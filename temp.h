@@ -7,10 +7,20 @@
 #include "relay.h"
 #include "switch.h"
 #include "display.h"
+#include "temperature.h"
 
 class Temp
 {
   public:
+    enum PARAM {   // settings to get/set (as shown in menu)
+      PAR_PAUSING = 0
+     ,PAR_B4START
+     ,PAR_RUNNING
+     ,PAR_B4STOP
+
+     ,PAR_COUNT
+     ,PAR_MAX = 9  // menu value of each setting: 0..PAR_MAX (max - min of settings[])
+    };
     enum SENSOR {  // values for num arg in info
       SENSOR_SOL  = 0
      ,SENSOR_POOL
@@ -21,6 +31,17 @@ class Temp
      ,SENSOR_COUNT
     };
 
+    struct decision {  // finalize result, that changed autoOn (packed)
+      word          min;    // ctrl->sec / 60 (wraps after 45 days)
+      byte          cause;  // RESULT | DEC_ON (switched on)
+      int8_t        diff;   // temperature difference in 1/4 K (saturated)
+      int8_t        thres;  // threshold in 1/4 K (saturated)
+    };
+    enum {
+      DEC_ON = 0x80  // cause: autoOn(1)
+     ,HIST_LEN = 12  // decisions kept (menu items 1..HIST_LEN)
+    };
+
   private:
     enum PERIOD {
       PERIOD_DAY  = 0
@@ -45,27 +66,46 @@ class Temp
      ,CAUSE_TIME  // time limits caused a change
      ,CAUSE_TEMP  // temperature values caused a change
     };
+    enum ERROR {   // return values for act, conv and data
+      ERR_NONE = 0
+     ,ERR_NO_SENSOR  // no valid device in list
+     ,ERR_NO_DEVICE  // no device detected
+     ,ERR_CRC        // data CRC invalid
+     ,ERR_DATA       // strange data
+    };
+    struct setting {      // adjustable shift value (menu shows 0..max-min)
+      byte Temp::*  shift;
+      byte          min;
+      byte          max;
+      byte          invert; // menu value is max - shift (otherwise shift - min)
+    };
     enum EEPROM_CONST {
       TEMP_FORMAT // we might want to change eeprom layout of temperature values only
     };
 
     struct mem {
-      char const * name;
+      char const * name;  // in flash
       byte const * addr;
       long         conv;  // conversion delay (set, when addr is ok)
       short        res;   // resolution mask (set on first data read)
-      short        temp;  // last read temperature value
-      short        avg;   // = (sum + 4) >> 3
-      short        sum;   // sum of 8 values for low pass filter
-      int16_t      min[PERIOD_COUNT]; // minimum avg of this day/week/month/year/overall
-      int16_t      max[PERIOD_COUNT]; // maximum avg of this day/week/month/year/overall
+      Temperature  temp;  // last read temperature value
+      Temperature  avg;   // = (sum + 4) >> 3
+      short        sum;   // sum of 8 raw values for low pass filter
+      Temperature  min[PERIOD_COUNT]; // minimum avg of this day/week/month/year/overall
+      Temperature  max[PERIOD_COUNT]; // maximum avg of this day/week/month/year/overall
     };
 
     byte index;      // device under test
     byte state;      // read status (0xe: counter 0x1: conv)
     byte devok;      // bit mask of successfully read temperature
     byte autoon;     // last value, when called relay->autoOn
+    byte gen;        // generation: incremented on change of backup values
+    byte last;       // last result of finalize
 
+    byte histNext;   // next entry of hist to write
+    byte histCount;  // valid entries in hist
+
+    decision hist[HIST_LEN];  // ring of last decisions
     mem  t[SENSOR_COUNT];     // config and read/calc. values of the sensors
     byte displayNum[SENSOR_COUNT];     // Display::NUM of each sensor
     byte sensorNum[Display::NUM_TEMP]; // Sensor::NUM of each temp. display number
@@ -76,14 +116,11 @@ class Temp
     byte          shiftRunning;
     byte          shiftB4Stop;
 
-    unsigned long secEnter;  // ctrl->sec, when we did enter the menu item "adjust shift..."
-
  // to debug:
-    byte          res;        // result of finalize (show in next loop)
     unsigned long time;       // time run / time paused
     unsigned long before;     // time run today before last switch on
-    short         diff;       // temperature difference
-    short         threshold;  // threshold to switch
+    Temperature   diff;       // temperature difference
+    Temperature   threshold;  // threshold to switch
 
  // loop ctrl:
     long      usecNextaction; // micros, when to perform next action
@@ -92,15 +129,17 @@ class Temp
     OneWire * ow;
     Ctrl    * ctrl;
 
+    static setting const settings[];  // in flash
+
 
     void         check( mem * m );    // check addr
-    char const * act(void);           // perform next action
-    char const * conv(void);          // start conversion
-    char const * data(void);          // read data
+    byte         act(void);           // perform next action / return: ERROR
+    byte         conv(void);          // start conversion
+    byte         data(void);          // read data
     boolean      next( boolean restart = false ); // increase index to next having conv
     byte         finalize(void);      // temperatures read - calculate pump switching
     void         restart(void);       // set index to 1st having conv or SENSOR_COUNT
-    int8_t       tocelsius(short raw);// 0..07ff -> 0..7f / ?800..?fff -> 80..ff
+    void         remember(void);      // store last decision in hist
 
   public:
     Temp();
@@ -108,14 +147,24 @@ class Temp
     void loop(void);
 
     void night( byte isNight );  // currently becoming night or day
+    byte generation() { return gen; }
+    byte sensorsOk()  { return devok; }  // bit mask of sensors read in current cycle
+    byte result()     { return last; }   // last result of finalize
 
-    short raw( byte sensorIdx ) { return t[sensorIdx].temp; }
-    short avg( byte sensorIdx ) { return t[sensorIdx].avg; }
+    Temperature raw( byte sensorIdx ) { return t[sensorIdx].temp; }
+    Temperature avg( byte sensorIdx ) { return t[sensorIdx].avg; }
 
+    enum { BACKUP_LEN = 6 + SENSOR_COUNT * (1 + 2 * sizeof(mem::min)) };  // bytes written by backup() at most
     int    backup( int addr );        // in: start address behind length / return: end address + 1
     void   restore( int addr, uint8_t len );
 
-    char * showThres( char * buf, byte menuitem, byte init );
+    long    get( byte par );            // setting as shown in menu
+    boolean set( byte par, long val );  // false: out of range (limits of menu)
+
+    boolean history( byte idx, decision & d );  // idx 0: newest / false: no such entry
+
+    char * showThres( char * buf, byte menuitem );
+    char * showHist(  char * buf, byte menuitem );
     char * showValue( char * buf, byte menuitem, byte num );
 };
 
@@ -0,0 +1,53 @@
+#ifndef Temperature_h
+#define Temperature_h
+
+#include <Arduino.h>
+#include "display.h"
+
+class Temperature  // DS18x20 value or difference in 1/16 degree (Q11.4)
+{
+  public:
+    enum {
+      ONE     = 16      // 1 degree
+     ,MAX     = 0x7ffe  // saturation limit (+/-)
+     ,INVALID = 0x7fff  // not yet read
+    };
+
+  private:
+    int16_t   val;
+
+    constexpr Temperature( int16_t raw, byte ) : val( raw ) {}
+
+    static constexpr int16_t sat( long raw ) {  // limit to +/- MAX
+      return (raw > MAX) ? MAX : (raw < -MAX) ? -MAX : (int16_t) raw;
+    }
+
+  public:
+    constexpr Temperature() : val( INVALID ) {}
+
+    static constexpr Temperature fromRaw( long raw ) { return Temperature( sat( raw ), 0 ); }
+    static constexpr Temperature celsius( int c )    { return fromRaw( (long) c * ONE ); }
+    static constexpr Temperature decicelsius( int dc ) {  // e.g. decicelsius( 15 ) = 1,5 C
+      return fromRaw( ((long) dc * ONE + ((dc < 0) ? -5 : 5)) / 10 );
+    }
+
+    constexpr int16_t raw(void)   const { return val; }
+    constexpr boolean valid(void) const { return val != INVALID; }
+    constexpr int8_t  toCelsius(void) const {  // rounded, 128 C and more -> 127 C
+      return (val >= (128 * ONE)) ? 127 : (int8_t) ((val + (ONE / 2)) / ONE);
+    }
+
+    constexpr Temperature operator+( Temperature t ) const { return fromRaw( (long) val + t.val ); }
+    constexpr Temperature operator-( Temperature t ) const { return fromRaw( (long) val - t.val ); }
+
+    constexpr boolean operator==( Temperature t ) const { return val == t.val; }
+    constexpr boolean operator!=( Temperature t ) const { return val != t.val; }
+    constexpr boolean operator< ( Temperature t ) const { return val <  t.val; }
+    constexpr boolean operator<=( Temperature t ) const { return val <= t.val; }
+    constexpr boolean operator> ( Temperature t ) const { return val >  t.val; }
+    constexpr boolean operator>=( Temperature t ) const { return val >= t.val; }
+
+    char * print( char * buf ) const { return Display::kelvin( buf, val ); }  // " x,y" (see kelvin)
+};
+
+#endif
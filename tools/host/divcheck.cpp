@@ -0,0 +1,56 @@
+// division by constants of display.cpp (div10(), DIVxx(), quot14())
+// against the division operator: all 16 bit / 32 bit arguments
+// (long has 64 bits here: mulhi() builds the product of 16 x 16 bit parts as on AVR)
+#include <stdio.h>
+#include "sim.h"
+
+#include "../../display.cpp"  // static helpers (run.sh does not link display.cpp)
+#include "../../piscino.ino"
+
+template <class DIV> static void check( char const * name, unsigned long d, DIV div )  // div inlined
+{
+  unsigned long bad = 0;
+  unsigned long x   = 0;
+  do
+    bad += (div( x ) != x / d);
+  while (++x <= 0xffffffffUL);
+  printf( "DIV%-5s: %lu of 2^32 wrong\n", name, bad );
+  simCheck( ! bad, "DIV%s()", name );
+}
+
+#define CHECK( d )  check( #d, d, [] ( unsigned long x ) { return DIV##d( x ); } )
+
+int main( void )
+{
+  unsigned long bad = 0;
+  for (unsigned long v = 0; v <= 0xffff; ++v) {
+    word q = v;
+    byte const r = div10( q );
+    bad += (q != v / 10) || (r != v % 10);
+  }
+  printf( "div10:    %lu of 65536 wrong\n", bad );
+  simCheck( ! bad, "div10()" );
+
+  CHECK( 24 );
+  CHECK( 60 );
+  CHECK( 100 );
+  CHECK( 3600 );
+  CHECK( 10000 );
+  CHECK( 86400 );
+
+  // quot14(): quotient less than 2^14, den < 2^18 (no overflow of den << 13 on AVR)
+  bad = 0;
+  uint32_t seed = 1;
+  for (unsigned long i = 0; i < 10000000UL; ++i) {
+    seed = seed * 1664525UL + 1013904223UL;
+    unsigned long const den = (seed >> 14) | 1;
+    seed = seed * 1664525UL + 1013904223UL;
+    unsigned long const num = ((unsigned long long) seed * (den << 14)) >> 32;
+    bad += (quot14( num, den ) != num / den);
+  }
+  printf( "quot14:   %lu of 10^7 random wrong\n", bad );
+  simCheck( ! bad, "quot14()" );
+
+  printf( simFailed ? "divcheck: FAILED\n" : "divcheck: ok\n" );
+  return simFailed != 0;
+}
@@ -0,0 +1,60 @@
+// host build: the part of the Arduino core used by piscino (see ../sim.cpp)
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+typedef uint8_t  byte;
+typedef uint16_t word;
+typedef bool     boolean;
+
+#define HIGH          1
+#define LOW           0
+#define INPUT         0
+#define OUTPUT        1
+#define INPUT_PULLUP  2
+#define HEX          16
+
+unsigned long millis( void );
+unsigned long micros( void );
+void delay( unsigned long ms );
+void delayMicroseconds( unsigned int us );
+
+void pinMode( uint8_t pin, uint8_t mode );
+void digitalWrite( uint8_t pin, uint8_t val );
+int  digitalRead( uint8_t pin );
+int  analogRead( uint8_t pin );
+
+void noInterrupts( void );
+void interrupts( void );
+
+#define bitRead( v, b )  (((v) >> (b)) & 1)
+
+class __FlashStringHelper;
+#define F( s )  ((const __FlashStringHelper *) PSTR( s ))
+
+class HardwareSerial
+{
+  public:
+    void   begin( long baud );
+    int    available( void );
+    int    read( void );
+    int    availableForWrite( void );
+    size_t write( uint8_t c );
+    void   flush( void );
+
+    template <class T> size_t print( T )        { return 0; }  // debug text is not simulated
+    template <class T> size_t print( T, int )   { return 0; }
+    template <class T> size_t println( T )      { return 0; }
+    size_t                    println( void )   { return 0; }
+    size_t                    print( const char * str );    // RAM strings kept (strings.sh)
+    size_t                    println( const char * str );
+};
+extern HardwareSerial Serial;
+
+#endif
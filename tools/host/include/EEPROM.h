@@ -0,0 +1,15 @@
+// host build: byte access as by avr-libc eeprom_read/write_byte() (see ../sim.cpp)
+#ifndef EEPROM_h
+#define EEPROM_h
+
+#include <stdint.h>
+
+struct EEPROMClass
+{
+  uint8_t read( int addr );
+  void    write( int addr, uint8_t val );
+  void    update( int addr, uint8_t val );
+};
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,18 @@
+// host build: no devices on the bus
+#ifndef OneWire_h
+#define OneWire_h
+
+#include <stdint.h>
+
+class OneWire
+{
+  public:
+    OneWire( uint8_t pin );
+    uint8_t reset( void );
+    void    select( const uint8_t * rom );
+    void    write( uint8_t v, uint8_t power = 0 );
+    uint8_t read( void );
+    static uint8_t crc8( const uint8_t * addr, uint8_t len );
+};
+
+#endif
@@ -0,0 +1,9 @@
+// host build: interrupt handlers are plain functions, called by the simulation
+#ifndef _AVR_INTERRUPT_H_
+#define _AVR_INTERRUPT_H_
+
+#define ISR( vector )  extern "C" void vector( void )
+#define cli()
+#define sei()
+
+#endif
@@ -0,0 +1,77 @@
+// host build: the ATmega328 registers used by piscino are plain variables (see ../sim.cpp)
+#ifndef _AVR_IO_H_
+#define _AVR_IO_H_
+
+#include <stdint.h>
+
+extern volatile uint8_t  MCUSR, SREG;
+extern volatile uint8_t  ADCSRA, ADCSRB, ADMUX, DIDR0;
+extern volatile uint16_t ADC;
+extern volatile uint8_t  PCICR, PCMSK1;
+extern volatile uint8_t  UCSR0A, UCSR0B, UCSR0C, UDR0;
+extern volatile uint16_t UBRR0;
+extern volatile uint8_t  TCCR2A, TCCR2B, TCNT2, OCR2A, TIMSK2, TIFR2;
+extern volatile uint8_t  EECR, EEDR;
+extern volatile uint16_t EEAR;
+
+extern uint8_t simRam[2048];  // SRAM of globals, heap and stack (paint and high-water mark)
+#define RAMSTART  ((uintptr_t) simRam)
+#define RAMEND    ((uintptr_t) simRam + sizeof(simRam) - 1)
+
+// MCUSR
+#define WDRF    3
+#define BORF    2
+#define EXTRF   1
+#define PORF    0
+
+// ADCSRA, ADMUX
+#define ADEN    7
+#define ADSC    6
+#define ADATE   5
+#define ADIF    4
+#define ADIE    3
+#define ADPS2   2
+#define ADPS1   1
+#define ADPS0   0
+#define REFS0   6
+
+// PCICR, PCMSK1
+#define PCIE1   1
+#define PCINT9  1
+
+// UCSR0A, UCSR0B, UCSR0C
+#define RXC0    7
+#define TXC0    6
+#define UDRE0   5
+#define FE0     4
+#define DOR0    3
+#define UPE0    2
+#define U2X0    1
+#define RXCIE0  7
+#define TXCIE0  6
+#define UDRIE0  5
+#define RXEN0   4
+#define TXEN0   3
+#define UPM01   5
+#define UCSZ00  1
+
+// TCCR2B, TIMSK2, TIFR2
+#define CS22    2
+#define CS21    1
+#define CS20    0
+#define OCIE2A  1
+#define OCF2A   1
+
+// EECR
+#define EEPM1   5
+#define EEPM0   4
+#define EERIE   3
+#define EEMPE   2
+#define EEPE    1
+#define EERE    0
+
+#ifndef F_CPU
+#define F_CPU  16000000L
+#endif
+
+#endif
@@ -0,0 +1,43 @@
+// host build: flash is ordinary memory (own section to tell it from RAM data, see strings.sh)
+#ifndef _AVR_PGMSPACE_H_
+#define _AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PROGMEM      __attribute__(( section( ".progmem.data" ) ))
+#define PGM_P        const char *
+#define PSTR( s )    (__extension__( { static const char __c[] PROGMEM = (s); & __c[0]; } ))
+
+#define memcpy_P     memcpy
+#define memcmp_P     memcmp
+#define strlen_P     strlen
+#define strcpy_P     strcpy
+#define strncpy_P    strncpy
+#define strcmp_P     strcmp
+#define strncmp_P    strncmp
+
+#define pgm_read_byte( a )   (*(const uint8_t  *) (a))
+#define pgm_read_word( a )   (*(const uint16_t *) (a))
+#define pgm_read_dword( a )  (*(const uint32_t *) (a))
+#define pgm_read_ptr( a )    (*(void * const *) (a))
+
+static inline char * ultoa( unsigned long v, char * buf, int )  // base 10 (no format string in .rodata)
+{
+  char * cp = buf;
+  do *cp++ = '0' + (v % 10); while (v /= 10);
+  *cp = 0;
+  for (char * lo = buf; lo < --cp; ++lo) { char const c = *lo; *lo = *cp; *cp = c; }
+  return buf;
+}
+static inline char * ltoa( long v, char * buf, int base )
+{
+  if (v >= 0)
+    return ultoa( v, buf, base );
+  *buf = '-';
+  ultoa( - (unsigned long) v, buf + 1, base );
+  return buf;
+}
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef _AVR_WDT_H_
+#define _AVR_WDT_H_
+
+#define WDTO_250MS  4
+
+void wdt_enable( int timeout );
+void wdt_reset( void );
+void wdt_disable( void );
+
+#endif
@@ -0,0 +1,23 @@
+// host build: the avr-libc crc functions in C
+#ifndef _UTIL_CRC16_H_
+#define _UTIL_CRC16_H_
+
+#include <stdint.h>
+
+static inline uint16_t _crc16_update( uint16_t crc, uint8_t a )
+{
+  crc ^= a;
+  for (int i = 0; i < 8; ++i)
+    crc = (crc & 1) ? (crc >> 1) ^ 0xa001 : (crc >> 1);
+  return crc;
+}
+
+static inline uint16_t _crc_xmodem_update( uint16_t crc, uint8_t data )
+{
+  crc ^= (uint16_t) data << 8;
+  for (int i = 0; i < 8; ++i)
+    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+  return crc;
+}
+
+#endif
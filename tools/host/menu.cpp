@@ -0,0 +1,175 @@
+// menu adjust items (Display::showAdjust()): keys select the item, the value
+// changes every sec after 3 secs, stays at its limit and is written to the LCD
+// menu items beyond 15: all days of the ring (Relay::showDay()) and all
+// events of the journal (Journal::show())
+#include <stdio.h>
+#include <string.h>
+#include "sim.h"
+
+#define private public  // Lumi::midnight, Relay::saveDay(), Journal::QUEUE_LEN
+#include "../../piscino.ino"
+#undef private
+
+enum {  // categories of menuTable (display.cpp)
+  CAT_TIME  = 2
+ ,CAT_DOWN  = 3
+ ,CAT_PUMP  = 5
+ ,CAT_PDAYS = 7
+ ,CAT_THRES = 8
+ ,CAT_JOUR  = 10
+};
+
+static void enter( byte cat, byte item )  // from intro by keys
+{
+  if (display.menu())
+    display.toggleMode();  // info
+  display.toggleMode();    // intro
+  display.key( Display::KEY_CAT );  // intro -> 1st category
+  while (--cat)
+    display.key( Display::KEY_CAT );
+  while (item--)
+    display.key( Display::KEY_ITEM );
+  simSeconds( 1 );
+}
+
+static void shows( const char * row0, const char * row1 )
+{
+  simCheck( ! strncmp( simLcd( 0 ), row0, 16 ), "row 0 |%.16s| expected |%s|", simLcd( 0 ), row0 );
+  simCheck( ! strncmp( simLcd( 1 ), row1, 16 ), "row 1 |%.16s| expected |%s|", simLcd( 1 ), row1 );
+}
+
+static void timeoutAdjust( void )
+{
+  simBoot();
+  simSeconds( 6 );  // intro -> info
+  enter( CAT_PUMP, 5 );
+  shows( "Ausz. += 1:OO:OO", "Auszeit: 1:OO:OO" );
+  simSeconds( 3 );
+  shows( "Ausz. += 1:OO:OO", "Auszeit: 2:OO:OO" );
+  simCheck( relays[Circuit::PUMP].get( Relay::PAR_TIMEOUT ) == 120, "pump timeout not adjusted" );
+  simSeconds( 4 );
+  shows( "Ausz. += 1:OO:OO", "Auszeit: 6:OO:OO" );
+  simSeconds( 1 );
+  shows( "Limit erreicht  ", "Auszeit: 6:OO:OO" );
+  simCheck( relays[Circuit::LAMP].get( Relay::PAR_TIMEOUT ) == 60, "lamp timeout changed" );
+
+  display.key( Display::KEY_ITEM );  // -= 1 hour: down to TIMEOUT_MIN
+  simSeconds( 10 );
+  shows( "Limit erreicht  ", "Auszeit: O:O1:OO" );
+  printf( "timeout: 60 -> 360 -> %ld minutes\n", relays[Circuit::PUMP].get( Relay::PAR_TIMEOUT ) );
+}
+
+static void thresAdjust( void )
+{
+  simBoot();
+  simSeconds( 6 );
+  enter( CAT_THRES, 3 );
+  shows( "Einst.-=       1", "Pause (ein):   4" );
+  simSeconds( 7 );
+  shows( "Limit erreicht  ", "Pause (ein):   O" );
+  simCheck( temp.get( Temp::PAR_PAUSING ) == 0, "pausing not at 0" );
+  printf( "threshold: 4 -> %ld\n", temp.get( Temp::PAR_PAUSING ) );
+}
+
+static void lumAdjust( void )
+{
+  simBoot();
+  simSeconds( 6 );
+  lumi.set( Lumi::PAR_LUMSWITCH, 379 );  // 37%
+  enter( CAT_DOWN, 9 );  // item 2 skipped: no midnight
+  shows( "Schalt+=     1O%", "Schaltpunkt: 37%" );
+  static byte const expect[] = { 50, 60, 70, 80, 90, 91, 92 };  // snapped, 1% steps at 100%
+  simSeconds( 2 );  // 1st step after 3 secs in the item
+  for (byte i = 0; i < sizeof(expect); ++i) {
+    simSeconds( 1 );
+    long const pct = ((lumi.get( Lumi::PAR_LUMSWITCH ) * 25) + 0x80) >> 8;
+    simCheck( pct == expect[i], "step %u: %ld%% expected %u%%", i, pct, expect[i] );
+  }
+  printf( "lum switch: 37%% -> %ld%%\n", ((lumi.get( Lumi::PAR_LUMSWITCH ) * 25) + 0x80) >> 8 );
+}
+
+static void clockAdjust( void )
+{
+  simBoot();
+  simSeconds( 6 );
+  enter( CAT_TIME, 2 );  // clock unknown: items skipped -> header
+  shows( "Uhrzeit         ", "anzeigen        " );
+
+  lumi.midnight = ctrl.sec - 3600;  // 1:00:00
+  enter( CAT_TIME, 2 );
+  shows( "Zeit  += 1:OO:OO", "Uhrzeit: 1:OO:O1" );
+  simSeconds( 3 );
+  simCheck( lumi.get( Lumi::PAR_SECCORR ) == -3600, "secCorr %ld", lumi.get( Lumi::PAR_SECCORR ) );
+  shows( "Zeit  += 1:OO:OO", "Uhrzeit: 2:OO:O4" );
+  simSeconds( 3 );
+  shows( "Zeit  += 1:OO:OO", "Uhrzeit: 5:OO:O7" );
+  simSeconds( 1 );  // SECCORR_MAX: 4 hours
+  shows( "Limit erreicht  ", "Uhrzeit: 5:OO:O8" );
+  printf( "clock: 1:00:00 -> 5:00:08, secCorr %ld\n", lumi.get( Lumi::PAR_SECCORR ) );
+}
+
+static void days( void )
+{
+  simBoot();
+  simSeconds( 6 );
+  Relay & pump = relays[Circuit::PUMP];
+  for (byte d = 1; d <= Relay::DAYS + 2; ++d) {  // day n: n minutes on
+    pump.todayOn = d * 60000L;
+    pump.saveDay();
+  }
+
+  char day[17];
+  for (byte item = 1; item <= Relay::DAYS; ++item) {
+    enter( CAT_PDAYS, item );
+    snprintf( day, sizeof(day), "Tag -%2u:", item );
+    for (char * cp = day; *cp; ++cp)
+      if (*cp == '0')
+        *cp = 'O';
+    simCheck( ! strncmp( simLcd( 0 ), day, 8 ), "item %u: |%.16s|", item, simLcd( 0 ) );
+  }
+  shows( "Tag -3O:   O mal", "ein:      3:OO m" );  // oldest: day 3
+  display.key( Display::KEY_ITEM );
+  simSeconds( 1 );
+  shows( "Pumpe: letzte   ", "Tage            " );
+  printf( "days: %u items\n", Relay::DAYS );
+}
+
+static void journalItems( void )
+{
+  simBoot();
+  simSeconds( 6 );
+  for (byte n = 0; n < 70; ++n) {  // more than the ring holds
+    if (journal.qlen >= Journal::QUEUE_LEN)
+      journal.flush();
+    journal.put( Journal::EV_LAMP_MODE, n & 3 );
+  }
+  journal.flush();
+
+  byte item;
+  char num[3];
+  for (item = 1; ; ++item) {
+    enter( CAT_JOUR, item );
+    if (! strncmp( simLcd( 0 ), "Ereignis-", 9 ))
+      break;  // header: no more events
+    snprintf( num, sizeof(num), "%2u", item );
+    for (char * cp = num; *cp; ++cp)
+      if (*cp == '0')
+        *cp = 'O';
+    simCheck( ! strncmp( simLcd( 0 ) + 14, num, 2 ), "item %u: |%.16s|", item, simLcd( 0 ) );
+  }
+  simCheck( item == Journal::EE_SLOTS, "%u events shown", item - 1 );
+  printf( "journal: %u events\n", item - 1 );
+}
+
+int main( void )
+{
+  int failed = 0;
+  failed += simFork( timeoutAdjust );
+  failed += simFork( thresAdjust );
+  failed += simFork( lumAdjust );
+  failed += simFork( clockAdjust );
+  failed += simFork( days );
+  failed += simFork( journalItems );
+  printf( "%s\n", failed ? "FAILED" : "ok" );
+  return failed != 0;
+}
@@ -0,0 +1,127 @@
+// power fail simulation: counters written by the PCINT1 interrupt survive the
+// restart, a torn record is rejected, and an interrupt in the middle of an
+// EEPROM access of the main loop (backup) leaves that access intact
+#include <stdio.h>
+#include "sim.h"
+
+#define private public  // Ctrl::EE_ADDR_PFAIL etc.
+#include "../../piscino.ino"
+#undef private
+
+enum { RUN = 3000 };  // seconds pump on before power fail (before the hourly checkpoint)
+
+static void powerFail( void )
+{
+  simPin[PIN_PowerFail] = LOW;
+  PCINT1_vect();
+}
+
+static bool recordValid( void )
+{
+  uint8_t sum = 0;
+  for (int i = 0; i < Ctrl::EE_PFAIL_LEN; ++i)
+    sum += simEeprom[Ctrl::EE_ADDR_PFAIL + i];
+  return sum == 0xff;  // checksum is ~sum of the others
+}
+
+static void pumpThenFail( void )
+{
+  simBoot();
+  relays[Circuit::PUMP].swMode( Switch::ON );
+  simSeconds( RUN );
+  unsigned long const w = simEeWrites;
+  powerFail();
+  printf( "power fail after %u s: %lu bytes written\n", RUN, simEeWrites - w );
+  simCheck( recordValid(), "power fail record not valid" );
+}
+
+static void restart( void )
+{
+  simBoot();
+  printf( "restart: uptime %lu s, pump total %lu s, today %lu s\n",
+          ctrl.totalOn, relays[Circuit::PUMP].total(), relays[Circuit::PUMP].today() );
+  simCheck( ctrl.totalOn >= RUN - 1, "uptime lost" );
+  simCheck( relays[Circuit::PUMP].total() >= RUN - 1, "pump total lost" );
+  simCheck( relays[Circuit::PUMP].today() >= RUN - 1, "pump today lost" );
+}
+
+static void restartTorn( void )
+{
+  simBoot();
+  printf( "restart with torn record: uptime %lu s, pump total %lu s\n",
+          ctrl.totalOn, relays[Circuit::PUMP].total() );
+  simCheck( ctrl.totalOn == 0, "torn record used" );
+  simCheck( relays[Circuit::PUMP].total() == 0, "torn record used for pump" );
+}
+
+// interrupt during Ctrl::backup() at the EEPROM access number fireAt
+static unsigned long fireAt;
+
+static void fire( void )
+{
+  if (--fireAt)
+    return;
+  simEeHook = 0;
+  powerFail();
+}
+
+static void backup( void )
+{
+  ctrl.backup( Lumi::MANUAL );
+}
+
+static void backupInterrupted( void )
+{
+  simEeHook = fire;
+  ctrl.backup( Lumi::MANUAL );
+  simEeHook = 0;
+}
+
+static void race( void )
+{
+  simBoot();
+  relays[Circuit::PUMP].swMode( Switch::ON );
+  simSeconds( RUN );
+
+  uint8_t start[sizeof(simEeprom)];
+  uint8_t ref[sizeof(simEeprom)];
+  memcpy( start, simEeprom, sizeof(start) );
+  simFork( backup );  // without interrupt: power fail record not written
+  memcpy( ref, simEeprom, sizeof(ref) );
+
+  int const pf  = Ctrl::EE_ADDR_PFAIL;
+  int const end = Ctrl::EE_ADDR_PFAIL + Ctrl::EE_PFAIL_LEN;
+  unsigned long n, bad = 0;
+  for (n = 1; n < 10000; ++n) {
+    fireAt = n;
+    memcpy( simEeprom, start, sizeof(start) );
+    simFailed += simFork( backupInterrupted );
+    if (! memcmp( simEeprom + pf, ref + pf, end - pf ))
+      break;  // backup done before access n
+    if (memcmp( simEeprom, ref, pf ) || memcmp( simEeprom + end, ref + end, sizeof(ref) - end ) || ! recordValid())
+      ++bad;
+  }
+  printf( "interrupt at each of %lu EEPROM accesses of a backup: %lu images differ\n", n - 1, bad );
+  simCheck( (n > 1) && ! bad, "interrupt corrupts EEPROM access of the main loop" );
+}
+
+int main( void )
+{
+  int failed = 0;
+
+  memset( simEeprom, 0xff, sizeof(simEeprom) );
+  failed += simFork( pumpThenFail );
+  uint8_t image[sizeof(simEeprom)];
+  memcpy( image, simEeprom, sizeof(image) );
+  failed += simFork( restart );
+
+  memcpy( simEeprom, image, sizeof(image) );
+  simEeprom[Ctrl::EE_ADDR_PFAIL + 1] ^= 0x01;  // power gone while writing the record
+  failed += simFork( restartTorn );
+
+  memset( simEeprom, 0xff, sizeof(simEeprom) );
+  failed += simFork( race );
+
+  printf( failed ? "pfail: FAILED\n" : "pfail: ok\n" );
+  return failed != 0;
+}
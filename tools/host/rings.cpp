@@ -0,0 +1,145 @@
+// EEPROM rings with end mark: power cut at each EEPROM access while a new
+// entry is written - after restart the ring holds the entries before or after
+//   relay days (Relay::saveDay()) - one day more than the ring holds
+//   journal (Journal::flush())      - twice around the ring
+#include <setjmp.h>
+#include <stdio.h>
+#include "sim.h"
+
+#define private public  // Relay::saveDay() etc.
+#include "../../piscino.ino"
+#undef private
+
+static jmp_buf       cut;
+static unsigned long cutAt;  // EEPROM access of power cut (0: none)
+static unsigned      count;  // entries written before
+
+static void powerCut( void )
+{
+  if (--cutAt)
+    return;
+  simEeHook = 0;
+  longjmp( cut, 1 );
+}
+
+static void cutWhile( void (* fn)( void ) )
+{
+  if (! setjmp( cut )) {
+    simEeHook = cutAt ? powerCut : 0;
+    fn();
+  }
+  simEeHook = 0;
+}
+
+// relay days: day n (1..) with n minutes on
+static Relay & pump( void ) { return relays[Circuit::PUMP]; }
+
+static void saveDay( void )
+{
+  pump().todayOn = (count + 1) * 60000L;
+  pump().saveDay();
+}
+
+static void dayCut( void )
+{
+  simBoot();
+  cutWhile( saveDay );
+}
+
+static void dayCheck( void )
+{
+  simBoot();
+  word minutes[Relay::DAYS];
+  byte n, sw;
+  for (n = 0; n < Relay::DAYS; ++n)
+    if (! pump().day( n, minutes[n], sw ))
+      break;
+
+  // days before (count) or after (count + 1): the new one may be torn,
+  // the oldest one of a full ring may be torn or gone (slot of the end mark)
+  bool ok = false;
+  for (unsigned c = count; ! ok && (c <= count + 1); ++c) {
+    bool const full = (c >= Relay::DAYS);
+    ok = full ? (n >= Relay::DAYS - 1) : (n == c);
+    for (byte i = (c > count) ? 1 : 0; ok && (i < n); ++i)
+      ok = (minutes[i] == c - i) || (full && (i == n - 1));
+  }
+  simCheck( ok, "days %u, cut at access %lu: %u days, newest %u", count, cutAt, n, n ? minutes[0] : 0 );
+}
+
+// journal: flush number n writes EV_BOOT and BATCH - 1 records EV_LOST
+// with value 0, 1, 2, ... (mod 256)
+enum { BATCH = 5 };  // 64 slots: flushes end at any slot
+
+static bool written( Journal::record const & r, unsigned k )  // record number k (0..)
+{
+  if (! (k % BATCH))
+    return r.type == Journal::EV_BOOT;
+  return (r.type == Journal::EV_LOST) && (r.val == (byte) (k / BATCH * (BATCH - 1) + k % BATCH - 1));
+}
+
+static void flush( void )
+{
+  journal.flush();
+}
+
+static void journalCut( void )
+{
+  simBoot();  // queues EV_BOOT
+  for (byte i = 1; i < BATCH; ++i)
+    journal.put( Journal::EV_LOST, count * (BATCH - 1) + i - 1 );
+  cutWhile( flush );
+}
+
+static void journalCheck( void )
+{
+  simBoot();
+  Journal::record r[Journal::EE_SLOTS];
+  byte n;
+  for (n = 0; n < Journal::EE_SLOTS - 1; ++n)
+    if (! journal.get( n + 1, r[n] ))  // 0: EV_BOOT of this start up
+      break;
+
+  // newest first: the records of count or count + 1 flushes - before: without
+  // the slots of the new end mark, after: all but the first ones of an empty ring
+  unsigned const before = (count * BATCH < Journal::EE_SLOTS - 1) ? count * BATCH : Journal::EE_SLOTS - 1;
+  bool ok = false;
+  for (unsigned c = count; ! ok && (c <= count + 1); ++c) {
+    ok = (n + BATCH >= before) && (n <= c * BATCH);
+    for (byte i = 0; ok && (i < n); ++i)
+      ok = written( r[i], c * BATCH - 1 - i );
+  }
+  simCheck( ok, "flushes %u, cut at access %lu: %u records, newest type %u value %u",
+            count, cutAt, n, n ? r[0].type : 0, n ? r[0].val : 0 );
+}
+
+static unsigned ring( void (* cutFn)( void ), void (* checkFn)( void ), unsigned entries, unsigned accesses )
+{
+  unsigned cuts = 0;
+  memset( simEeprom, 0xff, sizeof(simEeprom) );
+  for (count = 0; count < entries; ++count) {
+    uint8_t before[sizeof(simEeprom)];
+    memcpy( before, simEeprom, sizeof(before) );
+    for (cutAt = 1; cutAt <= accesses; ++cutAt, ++cuts) {  // last one: not cut
+      memcpy( simEeprom, before, sizeof(before) );
+      simFailed += simFork( cutFn );
+      simFailed += simFork( checkFn );
+    }
+    memcpy( simEeprom, before, sizeof(before) );
+    cutAt = 0;
+    simFailed += simFork( cutFn );
+  }
+  return cuts;
+}
+
+int main( void )
+{
+  unsigned cuts = ring( dayCut, dayCheck, Relay::DAYS + 3, 9 );
+  printf( "relay days: %u power cuts checked\n", cuts );
+
+  cuts = ring( journalCut, journalCheck, 2 * Journal::EE_SLOTS / BATCH + 1, 8 * BATCH + 3 );
+  printf( "journal: %u power cuts checked\n", cuts );
+
+  printf( simFailed ? "rings: FAILED\n" : "rings: ok\n" );
+  return simFailed != 0;
+}
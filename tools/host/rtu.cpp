@@ -0,0 +1,114 @@
+// Modbus RTU slave (MODBUS): frames of a master through the USART and Timer2
+// interrupts - responses, crc, exceptions, broadcast and broken frames
+#include <stdio.h>
+#include <util/crc16.h>
+#include "sim.h"
+
+#include "../../piscino.ino"
+
+static word crc( uint8_t const * buf, byte len )
+{
+  word crc = 0xffff;
+  for (byte i = 0; i < len; ++i)
+    crc = _crc16_update( crc, buf[i] );
+  return crc;
+}
+
+static uint8_t rsp[64];  // last response
+
+// send request (crc appended, unless bad) / return: response length (0: none)
+static byte request( char const * what, uint8_t const * req, byte len, bool bad = false, byte gapAt = 0 )
+{
+  uint8_t frame[64];
+  memcpy( frame, req, len );
+  word const c = crc( req, len ) ^ (bad ? 1 : 0);
+  frame[len++] = c;
+  frame[len++] = c >> 8;
+
+  for (byte i = 0; i < len; ++i) {
+    TCNT2  = (i && (i == gapAt)) ? 50 : 18;  // ticks since last char: 1.1 chars / 2.9 chars silence
+    UCSR0A = 0;
+    UDR0   = frame[i];
+    USART_RX_vect();
+  }
+  if (TIMSK2)
+    TIMER2_COMPA_vect();  // 3.5 chars silence
+  loop();
+
+  byte n = 0;
+  while ((UCSR0B & (1 << UDRIE0)) && (n < sizeof(rsp))) {
+    USART_UDRE_vect();
+    rsp[n++] = UDR0;
+  }
+  if (UCSR0B & (1 << TXCIE0))
+    USART_TX_vect();
+
+  printf( "%-28s", what );
+  for (byte i = 0; i < n; ++i)
+    printf( " %02x", rsp[i] );
+  printf( n ? "\n" : " (none)\n" );
+  simCheck( (n < 3) || ! crc( rsp, n ), "%s: response crc", what );
+  return n;
+}
+
+#define REQUEST( what, ... )  ({ static uint8_t const r[] = { __VA_ARGS__ }; request( what, r, sizeof(r) ); })
+
+static void expect( char const * what, byte n, uint8_t const * want, byte wlen )  // wlen without crc
+{
+  simCheck( (n == wlen + 2) && ! memcmp( rsp, want, wlen ), "%s: response", what );
+}
+
+#define EXPECT( what, n, ... )  ({ static uint8_t const w[] = { __VA_ARGS__ }; expect( what, n, w, sizeof(w) ); })
+
+int main( void )
+{
+  memset( simEeprom, 0xff, sizeof(simEeprom) );
+  simBoot();
+  simSeconds( 3 );
+
+  byte n = REQUEST( "read input 24..25", 1, 4, 0, 24, 0, 2 );
+  EXPECT( "uptime", n, 1, 4, 4, 0, 0, 0, (uint8_t) ctrl.sec );
+
+  n = REQUEST( "read holding 0..7", 1, 3, 0, 0, 0, 8 );
+  simCheck( (n == 21) && (rsp[2] == 16), "read holding: length" );
+  for (byte i = 0; i < 4; ++i)
+    simCheck( (rsp[3 + 2 * i] << 8 | rsp[4 + 2 * i]) == temp.get( i ), "holding %u", i );
+
+  n = REQUEST( "write single 6 = 1", 1, 6, 0, 6, 0, 1 );
+  EXPECT( "write single: echo", n, 1, 6, 0, 6, 0, 1 );
+  simCheck( relays[Circuit::PUMP].mode() == Switch::ON, "pump mode" );
+
+  n = REQUEST( "write multiple 4..5", 1, 16, 0, 4, 0, 2, 4, 0x02, 0x58, 0x02, 0xbc );
+  EXPECT( "write multiple: echo", n, 1, 16, 0, 4, 0, 2 );
+  simCheck( (lumi.get( Lumi::PAR_LUMSWITCH ) == 600) && (lumi.get( Lumi::PAR_LUMDAWN ) == 700), "luminance thresholds" );
+
+  static uint8_t const rd[] = { 1, 4, 0, 0, 0, 1 };
+  n = request( "bad crc", rd, sizeof(rd), true );
+  simCheck( ! n, "bad crc: answered" );
+  n = request( "gap in frame", rd, sizeof(rd), false, 3 );
+  simCheck( ! n, "gap in frame: answered" );
+  n = REQUEST( "other slave", 2, 4, 0, 0, 0, 1 );
+  simCheck( ! n, "other slave: answered" );
+  n = REQUEST( "read after bad frames", 1, 4, 0, 0, 0, 1 );
+  simCheck( n == 7, "read after bad frames" );
+
+  n = REQUEST( "illegal function 5", 1, 5, 0, 0, 0xff, 0 );
+  EXPECT( "exception 1", n, 1, 0x85, 1 );
+  n = REQUEST( "read input 25..26", 1, 4, 0, 25, 0, 2 );
+  EXPECT( "exception 2", n, 1, 0x84, 2 );
+  n = REQUEST( "read holding 0xffff", 1, 3, 0xff, 0xff, 0, 1 );
+  EXPECT( "exception 2 (0xffff)", n, 1, 0x83, 2 );
+  n = REQUEST( "write multiple 0xffff..", 1, 16, 0xff, 0xff, 0, 2, 4, 0, 1, 0, 1 );
+  EXPECT( "exception 2 (0xffff + 2)", n, 1, 0x90, 2 );
+  n = REQUEST( "read input count 0", 1, 4, 0, 0, 0, 0 );
+  EXPECT( "exception 3 (count)", n, 1, 0x84, 3 );
+  n = REQUEST( "write single 0 = 12", 1, 6, 0, 0, 0, 12 );
+  EXPECT( "exception 3 (range)", n, 1, 0x86, 3 );
+
+  n = REQUEST( "broadcast write 7 = 1", 0, 6, 0, 7, 0, 1 );
+  simCheck( ! n, "broadcast: answered" );
+  simCheck( relays[Circuit::LAMP].mode() == Switch::ON, "broadcast: lamp mode" );
+
+  printf( simFailed ? "rtu: FAILED\n" : "rtu: ok\n" );
+  return simFailed != 0;
+}
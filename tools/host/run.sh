@@ -0,0 +1,32 @@
+#!/bin/sh
+# host checks of the sketch: build each with g++ and run it
+# (stub Arduino core in include/, board simulation in sim.cpp)
+#
+# usage: tools/host/run.sh [check ...]    default: all checks
+set -e
+cd "$(dirname "$0")"
+src=../..
+out=${TMPDIR:-/tmp}/piscino-host
+mkdir -p "$out"
+
+CXX=${CXX:-g++}
+CXXFLAGS="-std=gnu++11 -O2 -w -Iinclude -include Arduino.h -D__data_start=simDataStart -D__heap_start=simHeapStart"
+
+# sketch sources: the check includes piscino.ino (globals, setup(), loop() and ISRs)
+build() {  # name, defines, source included by the check
+  $CXX $CXXFLAGS $2 -o "$out/$1" -x c++ "$1.cpp" $(ls $src/*.cpp | grep -v "/${3:-none}$") sim.cpp
+}
+
+checks=${*:-pfail rings rtu menu divcheck}
+for c in $checks; do
+  case $c in
+    pfail)    build pfail    "" ;;
+    rings)    build rings    "" ;;
+    rtu)      build rtu      -DMODBUS ;;
+    menu)     build menu     "" ;;
+    divcheck) build divcheck "" display.cpp ;;  # about 1 minute
+    *)        echo "unknown check: $c"; exit 2 ;;
+  esac
+  echo "== $c"
+  "$out/$c"
+done
@@ -0,0 +1,237 @@
+// host simulation of the piscino board (see sim.h)
+#include <stdarg.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <EEPROM.h>
+#include <OneWire.h>
+#include <avr/wdt.h>
+
+#include "sim.h"
+#include "../../ctrl.h"
+
+extern void setup( void );
+extern void loop( void );
+extern "C" void ADC_vect( void );
+
+volatile uint8_t  MCUSR, SREG;
+volatile uint8_t  ADCSRA, ADCSRB, ADMUX, DIDR0;
+volatile uint16_t ADC;
+volatile uint8_t  PCICR, PCMSK1;
+volatile uint8_t  UCSR0A, UCSR0B, UCSR0C, UDR0;
+volatile uint16_t UBRR0;
+volatile uint8_t  TCCR2A, TCCR2B, TCNT2, OCR2A, TIMSK2, TIFR2;
+volatile uint8_t  EECR, EEDR;
+volatile uint16_t EEAR;
+
+// the symbols of the AVR linker script used by Ctrl::ramFree() etc.
+// (renamed by run.sh: the host C library has its own __data_start)
+uint8_t simRam[2048];
+char  * __brkval;
+asm( ".globl simDataStart\n .set simDataStart, simRam + 0x100\n"
+     ".globl simHeapStart\n .set simHeapStart, simRam + 0x500\n" );
+
+static struct Paint { Paint() { memset( simRam, 0xc5, sizeof(simRam) ); } } paint;  // as paintRam()
+
+unsigned long simMicros;
+uint8_t       simPin[32];
+word          simAnalog[8];
+int           simFailed;
+
+unsigned long millis( void )                { return simMicros / 1000; }
+unsigned long micros( void )                { return simMicros; }
+void          delay( unsigned long ms )     { simMicros += ms * 1000; }
+void          delayMicroseconds( unsigned int us ) { simMicros += us; }
+void          noInterrupts( void )          {}
+void          interrupts( void )            {}
+void          pinMode( uint8_t, uint8_t )   {}
+int           analogRead( uint8_t pin )     { return simAnalog[pin & 7]; }
+
+void wdt_enable( int )   {}
+void wdt_reset( void )   {}
+void wdt_disable( void ) {}
+
+// HD44780 in 4 bit mode: nibbles latched on falling enable, busy flag never set
+static bool    lcd8bit = true;  // until function set to 4 bit
+static int     lcdHigh = -1;    // high nibble received
+static uint8_t lcdAddr;
+static char    lcdRam[0x80];
+
+static void lcdByte( bool data, uint8_t b )
+{
+  if (data)
+    lcdRam[lcdAddr++ & 0x7f] = b;
+  else if (b & 0x80)
+    lcdAddr = b & 0x7f;  // set DDRAM address
+  else if (b == 0x01) {
+    memset( lcdRam, ' ', sizeof(lcdRam) );  // clear display
+    lcdAddr = 0;
+  }
+}
+
+void digitalWrite( uint8_t pin, uint8_t val )
+{
+  bool const fall = (pin == PIN_LCD_Ena) && simPin[pin] && ! val;
+  simPin[pin & 31] = val;
+#ifndef KEYPAD
+  if (simPin[PIN_LCD_RW])
+    return;  // busy flag read
+#endif
+  if (! fall)
+    return;
+  uint8_t const n = simPin[PIN_LCD_DB4]      | simPin[PIN_LCD_DB5] << 1
+                  | simPin[PIN_LCD_DB6] << 2 | simPin[PIN_LCD_DB7] << 3;
+  if (lcd8bit) {
+    lcd8bit = (n != 0x2);
+    return;
+  }
+  if (lcdHigh < 0)
+    lcdHigh = n;
+  else {
+    lcdByte( simPin[PIN_LCD_RS], lcdHigh << 4 | n );
+    lcdHigh = -1;
+  }
+}
+
+int digitalRead( uint8_t pin )
+{
+  return (pin == PIN_LCD_DB7) ? LOW : simPin[pin & 31];  // LCD never busy
+}
+
+const char * simLcd( byte row )
+{
+  static char line[2][17];
+  memcpy( line[row], lcdRam + (row ? 0x40 : 0), 16 );
+  return line[row];
+}
+
+// serial output into a buffer, availableForWrite() set by the test
+HardwareSerial Serial;
+uint8_t      simTx[4096];
+int          simTxLen;
+int          simTxFree = 63;
+const char * simRx;
+
+void   HardwareSerial::begin( long )              {}
+void   HardwareSerial::flush( void )              {}
+size_t HardwareSerial::print( const char * )      { return 0; }
+size_t HardwareSerial::println( const char * )    { return 0; }
+int    HardwareSerial::available( void )          { return simRx && *simRx; }
+int    HardwareSerial::read( void )               { return (simRx && *simRx) ? *simRx++ : -1; }
+int    HardwareSerial::availableForWrite( void )  { return simTxFree; }
+size_t HardwareSerial::write( uint8_t c )
+{
+  simCheck( simTxFree > 0, "Serial.write() would block" );
+  --simTxFree;
+  simTx[simTxLen++ % sizeof(simTx)] = c;
+  return 1;
+}
+
+// EEPROM through EEAR/EEDR as by avr-libc: an interrupt may come between setting
+// the registers and the strobe (simEeHook), the strobe uses what is in them then
+uint8_t       simEeprom[1024];
+unsigned long simEeWrites;
+void       (* simEeHook)( void );
+
+EEPROMClass EEPROM;
+
+uint8_t EEPROMClass::read( int addr )
+{
+  EEAR = addr;
+  if (simEeHook)
+    simEeHook();
+  EEDR = simEeprom[EEAR & 0x3ff];
+  return EEDR;
+}
+
+void EEPROMClass::write( int addr, uint8_t val )
+{
+  EEAR = addr;
+  EEDR = val;
+  if (simEeHook)
+    simEeHook();
+  simEeprom[EEAR & 0x3ff] = EEDR;
+  ++simEeWrites;
+}
+
+void EEPROMClass::update( int addr, uint8_t val )
+{
+  if (read( addr ) != val)
+    write( addr, val );
+}
+
+// no temperature sensors: Temp reports ERR_NO_DEVICE
+OneWire::OneWire( uint8_t )            {}
+uint8_t OneWire::reset( void )         { return 0; }
+void    OneWire::select( const uint8_t * ) {}
+void    OneWire::write( uint8_t, uint8_t ) {}
+uint8_t OneWire::read( void )          { return 0xff; }
+uint8_t OneWire::crc8( const uint8_t * addr, uint8_t len )
+{
+  uint8_t crc = 0;
+  while (len--) {
+    uint8_t in = *addr++;
+    for (int i = 8; i; --i, in >>= 1)
+      crc = ((crc ^ in) & 1) ? (crc >> 1) ^ 0x8c : (crc >> 1);
+  }
+  return crc;
+}
+
+void simBoot( void )
+{
+  simPin[PIN_PowerFail] = HIGH;
+  setup();
+}
+
+void simSeconds( unsigned long secs )
+{
+  for (unsigned long ms = secs * 1000; ms; --ms) {
+    simMicros += 1000;
+    for (byte n = 10; n && (ADCSRA & (1 << ADSC)); --n) {  // about 10 conversions per msec
+      ADCSRA &= ~(1 << ADSC);
+      ADC = simAnalog[ADMUX & 7];
+      ADC_vect();  // starts the next one
+    }
+    loop();
+  }
+}
+
+int simFork( void (* fn)( void ) )
+{
+  int fd[2];
+  fflush( stdout );
+  if (pipe( fd ))
+    return -1;
+  pid_t const pid = fork();
+  if (! pid) {
+    close( fd[0] );
+    fn();
+    fflush( stdout );
+    if (write( fd[1], simEeprom, sizeof(simEeprom) ) != sizeof(simEeprom))
+      simFailed = 255;
+    _exit( simFailed > 255 ? 255 : simFailed );
+  }
+  close( fd[1] );
+  size_t n = 0;
+  for (ssize_t r = 1; (pid > 0) && (r > 0) && (n < sizeof(simEeprom)); n += r)
+    r = read( fd[0], simEeprom + n, sizeof(simEeprom) - n );
+  close( fd[0] );
+  int status = 0;
+  if ((pid < 0) || (waitpid( pid, & status, 0 ) != pid) || ! WIFEXITED( status ) || (n != sizeof(simEeprom)))
+    return 255;
+  return WEXITSTATUS( status );
+}
+
+void simCheck( bool ok, const char * fmt, ... )
+{
+  if (ok)
+    return;
+  va_list ap;
+  va_start( ap, fmt );
+  printf( "FAILED: " );
+  vprintf( fmt, ap );
+  printf( "\n" );
+  va_end( ap );
+  ++simFailed;
+}
@@ -0,0 +1,31 @@
+// host simulation of the piscino board: pins, ADC, EEPROM, LCD and serial
+// around the unchanged sketch sources (see run.sh)
+#ifndef Sim_h
+#define Sim_h
+
+#include <Arduino.h>
+
+extern unsigned long simMicros;         // micros(): advanced by simSeconds() or the test
+extern uint8_t       simPin[32];        // digital levels (relay outputs, switch and power fail inputs)
+extern word          simAnalog[8];      // analog inputs: result of conversions (0..1023)
+
+extern uint8_t       simEeprom[1024];
+extern unsigned long simEeWrites;       // bytes written by EEPROM.write()
+extern void       (* simEeHook)( void );  // called within each EEPROM access after EEAR/EEDR are set:
+                                          // an interrupt before the strobe of avr-libc
+
+extern int           simTxFree;         // Serial.availableForWrite()
+extern uint8_t       simTx[4096];       // bytes written by Serial.write()
+extern int           simTxLen;
+extern const char  * simRx;             // bytes for Serial.read() (0: none)
+
+extern int           simFailed;         // failed checks of this process
+
+void         simBoot( void );                  // supply ok: setup() on the EEPROM content
+void         simSeconds( unsigned long secs ); // loop() every msec, ADC conversions in between
+const char * simLcd( byte row );               // LCD content (16 chars) written by the Lcd driver
+int          simFork( void (* fn)( void ) );   // fn in a child (copy of this process), EEPROM image back
+                                               // return: failed checks of the child
+void         simCheck( bool ok, const char * fmt, ... );  // count and report a failed check
+
+#endif
@@ -0,0 +1,26 @@
+#!/bin/sh
+# constant bytes of the sketch sources by memory, measured on a host build:
+#   ram:   string literals (.rodata.str*) - avr-gcc copies them to SRAM at start up
+#   flash: PROGMEM tables, PSTR() and F() strings (.progmem.data, see include/avr/pgmspace.h)
+# no replacement for avr-size: tables of pointers are larger on the host (8 byte pointers)
+#
+# usage: tools/host/strings.sh [sketch dir [defines]]    default: this sketch
+#        (e.g. a git worktree of an older commit / defines e.g. -DDEBUG)
+set -e
+src=$(cd "${1:-$(dirname "$0")/../..}" && pwd)
+cd "$(dirname "$0")"
+out=${TMPDIR:-/tmp}/piscino-strings
+mkdir -p "$out"
+
+CXX=${CXX:-g++}
+CXXFLAGS="-std=gnu++11 -Os -fno-builtin -w -Iinclude -include Arduino.h"  # no literals folded into code
+
+printf "%-14s %6s %6s\n" file ram flash
+for f in "$src"/*.cpp "$src"/piscino.ino; do
+  o="$out/$(basename "$f").o"
+  $CXX $CXXFLAGS $2 -c -o "$o" -x c++ "$f"
+  size -A "$o" | awk -v f="$(basename "$f")" '
+    $1 ~ /^\.rodata\.str/   { ram   += $2 }
+    $1 == ".progmem.data"   { flash += $2 }
+    END { printf "%-14s %6u %6u\n", f, ram, flash }'
+done | awk '{ print; ram += $2; flash += $3 } END { printf "%-14s %6u %6u\n", "total", ram, flash }'
@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""decode the binary serial output of piscino (see telemetry.h and log.h)
+
+usage: telemetry.py csv [file]    status records (REC_STATUS) as CSV lines
+       telemetry.py log [file]    render debug messages (REC_LOG, DEBUG builds)
+
+file defaults to stdin, e.g. the serial device set up by
+    stty -F /dev/ttyUSB0 9600 raw
+frames with invalid crc (e.g. text of COMMANDS) are skipped and counted on stderr
+"""
+
+import csv
+import os
+import struct
+import sys
+
+REC_STATUS = 1
+REC_LOG    = 2
+
+# Temp::RESULT and Temp::ERROR
+RESULTS = ['NO_ACTION', 'RES_ERROR', 'NOT_COMPLETE',
+           'STILL_NIGHT', 'STAY_TIME', 'STAY_TEMP', 'STAY_COLD',
+           'CAUSE_NIGHT', 'CAUSE_TIME', 'CAUSE_TEMP']
+ERRORS  = ['ERR_NONE', 'ERR_NO_SENSOR', 'ERR_NO_DEVICE', 'ERR_CRC', 'ERR_DATA']
+MODES   = ['OFF', 'ON', 'AUTO', 'TEMP']  # Switch::MODE
+SENSORS = ['sol', 'pool', 'ins', 'air', 'box']
+
+STATUS  = struct.Struct('<BBI5h5hBBBIIBIIHBHHH')  # REC_STATUS (telemetry.h)
+
+
+def name(names, idx):
+    return names[idx] if idx < len(names) else '%u' % idx
+
+
+def crc_xmodem(data):
+    crc = 0
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+            crc &= 0xffff
+    return crc
+
+
+def cobs_decode(data):  # frame without delimiter / None: invalid
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if not code or (i + code > len(data)):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def records(stream):  # valid records (type first) of the byte stream
+    bad = 0
+    buf = bytearray()
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            break
+        buf += chunk
+        while True:
+            end = buf.find(0)
+            if end < 0:
+                break
+            frame = cobs_decode(bytes(buf[:end]))
+            del buf[:end + 1]
+            if frame is None:
+                bad += 1
+                continue
+            if len(frame) < 3:
+                continue  # empty frame
+            rec, crc = frame[:-2], frame[-2] | (frame[-1] << 8)
+            if crc_xmodem(rec) != crc:
+                bad += 1
+                continue
+            yield rec
+    if bad:
+        print('%u invalid frames skipped' % bad, file=sys.stderr)
+
+
+def text(raw):  # LCD content: custom characters are not printable
+    return ''.join(chr(b) if 0x20 <= b < 0x7f else '.' for b in raw)
+
+
+def version():
+    path = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'version.h')
+    try:
+        with open(path) as f:
+            return f.read().split('"')[1]
+    except (OSError, IndexError):
+        return '?'
+
+
+def render(msg, args):  # text of log.h for message id and args
+    if msg == 1:    # MSG_BOOT
+        return 'Piscino %s - (c) Holger Galuschka' % version()
+    if msg == 2:    # MSG_ALIVE
+        return ' alive: %u secs' % struct.unpack_from('<I', args)[0]
+    if msg == 3:    # MSG_LCD_INFO
+        return '    LCD info: |%s|%s|' % (text(args[:16]), text(args[16:32]))
+    if msg == 4:    # MSG_LCD_MENU
+        return '    LCD menu: |%s|%s|' % (text(args[:16]), text(args[16:32]))
+    if msg == 5:    # MSG_LCD_HINT
+        return '     (here: "%s")' % text(args)
+    if msg == 6:    # MSG_LCD_OOPS
+        return '     oops: "%s"' % text(args[:7])
+    if msg == 7:    # MSG_TEMP_ADDR
+        return '  device %u: CRC of address is not valid!' % args[0]
+    if msg == 8:    # MSG_TEMP_FAMILY
+        return '  device %u is not a DS18x20 family device (%02x)' % (args[0], args[1])
+    if msg == 9:    # MSG_TEMP_ERROR
+        return 'error on device %u: %s' % (args[0], name(ERRORS, args[1]))
+    if msg == 10:   # MSG_TEMP_DATA
+        return '  strange data for device %u: %s' % (args[0], ' '.join('%02x' % b for b in args[1:10]))
+    if msg == 11:   # MSG_TEMP_RESULT
+        result, before, time, thres, diff = struct.unpack_from('<BIIhh', args)
+        return '    %s (%u/%u/%.2f/%.2f)' % (name(RESULTS, result), before, time, thres / 16, diff / 16)
+    return 'message %u: %s' % (msg, args.hex())
+
+
+def log(stream):
+    for rec in records(stream):
+        if (rec[0] != REC_LOG) or (len(rec) < 3):
+            continue
+        lost, msg, args = rec[1], rec[2], rec[3:]
+        if lost:
+            print('(%u messages lost)' % lost)
+        try:
+            print(render(msg, args))
+        except (IndexError, struct.error):
+            print('message %u (short): %s' % (msg, args.hex()))
+
+
+def temp(raw):  # 1/16 C / empty: not yet read
+    return '' if raw == 0x7fff else '%.2f' % (raw / 16)
+
+
+def status(stream):
+    out = csv.writer(sys.stdout)
+    relay = ['on', 'mode', 'today', 'total']
+    out.writerow(['seq', 'lost', 'sec'] + SENSORS + ['avg_' + s for s in SENSORS] +
+                 ['devok', 'result'] + ['pump_' + r for r in relay] + ['lamp_' + r for r in relay] +
+                 ['lum', 'night', 'detect', 'ram_free', 'ram_heap', 'ram_globals'])
+    seq = None
+    for rec in records(stream):
+        if (rec[0] != REC_STATUS) or (len(rec) != STATUS.size):
+            continue
+        v = STATUS.unpack(rec)
+        lost = ((v[1] - seq - 1) & 0xff) if seq is not None else 0  # frames missed before
+        seq = v[1]
+        row = [v[1], lost, v[2]] + [temp(t) for t in v[3:13]] + ['%02x' % v[13], name(RESULTS, v[14])]
+        for on, today, total in ((v[15], v[16], v[17]), (v[18], v[19], v[20])):
+            row += [on & 1, name(MODES, on >> 4), today, total]
+        row += [v[21], v[22] & 1, (v[22] >> 1) & 1] + list(v[23:26])
+        out.writerow(row)
+        sys.stdout.flush()  # follow a serial device
+
+
+COMMANDS = {'csv': status, 'log': log}
+
+if __name__ == '__main__':
+    if (len(sys.argv) < 2) or (sys.argv[1] not in COMMANDS) or (len(sys.argv) > 3):
+        sys.exit(__doc__)
+    with (open(sys.argv[2], 'rb', buffering=0) if len(sys.argv) > 2 else sys.stdin.buffer) as f:
+        COMMANDS[sys.argv[1]](f)